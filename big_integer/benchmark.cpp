@@ -0,0 +1,151 @@
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "big_integer.hpp"
+#include "random_big_integer.hpp"
+
+// Sweeps operand sizes and prints one tab-separated line per operation and
+// size, so that runs of different versions can be diffed directly.
+//
+// Usage: benchmark [max_limbs] [seconds_per_point] [max_seconds_per_call]
+// An operation stops growing once a single call takes longer than the last
+// argument, which keeps the quadratic kernels from running for hours.
+
+static volatile std::size_t sink;
+
+std::vector<std::size_t> sweep_sizes(const std::size_t max_limbs)
+{
+    std::vector<std::size_t> sizes;
+    for (std::size_t decade = 1u; decade <= max_limbs; decade *= 10u)
+    {
+        for (const std::size_t step : {1u, 2u, 5u})
+        {
+            if (decade * step <= max_limbs)
+            {
+                sizes.push_back(decade * step);
+            }
+        }
+        if (decade > max_limbs / 10u)
+        {
+            break;
+        }
+    }
+
+    return sizes;
+}
+
+double measure(const std::function<void()> &call, const double seconds_per_point, std::size_t &iterations)
+{
+    typedef std::chrono::steady_clock clock;
+
+    iterations = 0u;
+    const clock::time_point start(clock::now());
+    double elapsed(0.0);
+    do
+    {
+        call();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < seconds_per_point);
+
+    return elapsed / double(iterations);
+}
+
+bool parse(const char *text, std::size_t &value)
+{
+    char *end(nullptr);
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return std::isdigit(static_cast<unsigned char>(*text)) && *end == '\0' && errno == 0;
+}
+
+bool parse(const char *text, double &value)
+{
+    char *end(nullptr);
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0' && std::isfinite(value) && value >= 0.0;
+}
+
+int main(int argc, char **argv)
+{
+    std::ios_base::sync_with_stdio(false);
+
+    std::size_t max_limbs(10000000u);
+    double seconds_per_point(0.2), max_seconds_per_call(2.0);
+    if (argc > 4 || (argc > 1 && (!parse(argv[1], max_limbs) || max_limbs == 0u))
+        || (argc > 2 && !parse(argv[2], seconds_per_point))
+        || (argc > 3 && (!parse(argv[3], max_seconds_per_call) || max_seconds_per_call == 0.0)))
+    {
+        std::cerr << "Usage: benchmark [max_limbs] [seconds_per_point] [max_seconds_per_call]\n";
+        return 1;
+    }
+
+    typedef std::function<std::function<void()>(RandomBigInteger &, std::size_t)> Setup;
+    const std::vector<std::pair<std::string, Setup>> operations{
+        {"add", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                const BigInteger a(generator.limbs(limbs)), b(generator.limbs(limbs));
+                return [a, b]() { sink = (a + b).size(); };
+            }},
+        {"multiply", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                const BigInteger a(generator.limbs(limbs)), b(generator.limbs(limbs));
+                return [a, b]() { sink = (a * b).size(); };
+            }},
+        {"square", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                const BigInteger a(generator.limbs(limbs));
+                return [a]() { sink = (a * a).size(); };
+            }},
+        {"divide", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                const BigInteger a(generator.limbs(2u * limbs)), b(generator.limbs(limbs));
+                return [a, b]() { sink = (a / b).size(); };
+            }},
+        {"power_eq", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                const BigInteger base(generator.limbs(1u)), exp(static_cast<unsigned long long>(limbs * 32u / base.bit_length()));
+                return [base, exp]() { BigInteger res(base); sink = power_eq(res, exp).size(); };
+            }},
+        {"decimal_output", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                const BigInteger a(generator.limbs(limbs));
+                return [a]() { std::ostringstream stream; stream << a; sink = stream.str().size(); };
+            }},
+        {"decimal_input", [](RandomBigInteger &generator, std::size_t limbs) -> std::function<void()>
+            {
+                std::ostringstream stream;
+                stream << generator.limbs(limbs);
+                const std::string text(stream.str());
+                return [text]() { std::istringstream stream(text); BigInteger a; stream >> a; sink = a.size(); };
+            }},
+    };
+
+    std::cout << "operation\tlimbs\titerations\tns_per_call\tns_per_limb\tlimbs_per_second\n";
+    for (const auto &operation : operations)
+    {
+        RandomBigInteger generator(20240601u);
+        for (const std::size_t limbs : sweep_sizes(max_limbs))
+        {
+            std::size_t iterations;
+            const double seconds(measure(operation.second(generator, limbs), seconds_per_point, iterations));
+            std::cout << operation.first << '\t' << limbs << '\t' << iterations << '\t'
+                << seconds * 1e9 << '\t' << seconds * 1e9 / double(limbs) << '\t'
+                << double(limbs) / seconds << '\n' << std::flush;
+            if (seconds > max_seconds_per_call)
+            {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
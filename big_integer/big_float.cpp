@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "./big_float.hpp"
+
+std::atomic<std::size_t> &BigFloat::default_digits()
+{
+    static std::atomic<std::size_t> digits(50u);
+    return digits;
+}
+
+std::size_t BigFloat::digits_to_limbs(const std::size_t digits)
+{
+    static const double limb_digits(std::log10(double(BigInteger::RADIX)));
+    return std::size_t(std::ceil(double(digits) / limb_digits)) + 1u;
+}
+
+void BigFloat::shift(BigInteger &obj, const std::size_t count)
+{
+    if (!obj.repres.empty())
+    {
+        obj.repres.insert(obj.repres.begin(), count, 0u);
+    }
+}
+
+void BigFloat::round(const bool sticky)
+{
+    BigInteger::Limbs &repres(mantissa.repres);
+    if (repres.size() > limbs)
+    {
+        const std::size_t cut(repres.size() - limbs);
+        const Integer first(repres[cut - 1u]);
+        bool is_up(first > BigInteger::HALF_OF_RADIX);
+        if (first == BigInteger::HALF_OF_RADIX)
+        {
+            bool is_tie(!sticky);
+            for (std::size_t k = 0u; k + 1u < cut && is_tie; ++k)
+            {
+                is_tie = !repres[k];
+            }
+            is_up = !is_tie || (repres[cut] & 1u);
+        }
+
+        repres.erase(repres.begin(), repres.begin() + cut);
+        exponent += exponent_type(cut);
+        if (is_up)
+        {
+            mantissa += BigInteger(1u);
+        }
+    }
+
+    std::size_t zeros(0u);
+    while (zeros < repres.size() && !repres[zeros])
+    {
+        ++zeros;
+    }
+    repres.erase(repres.begin(), repres.begin() + zeros);
+    exponent += exponent_type(zeros);
+    if (repres.empty())
+    {
+        exponent = 0;
+        negative = false;
+    }
+}
+
+BigInteger BigFloat::aligned(const exponent_type base) const
+{
+    // Mantissa scaled to RADIX^(base - 1). Limbs below RADIX^base are
+    // replaced by a single 1 one limb lower, which keeps the value strictly
+    // between the same neighbours of the rounding grid as the exact tail.
+    BigInteger res;
+    if (is_zero())
+    {
+        return res;
+    }
+    if (exponent >= base)
+    {
+        res = mantissa;
+        shift(res, std::size_t(exponent - base) + 1u);
+        return res;
+    }
+
+    const std::size_t cut(std::size_t(base - exponent));
+    res.repres.push_back(1u);
+    if (cut < mantissa.repres.size())
+    {
+        res.repres.insert(res.repres.end(), mantissa.repres.cbegin() + cut, mantissa.repres.cend());
+    }
+
+    return res;
+}
+
+BigFloat BigFloat::rounded(const std::size_t precision_limbs) const
+{
+    BigFloat res(*this);
+    if (res.mantissa.repres.size() > precision_limbs)
+    {
+        res.limbs = precision_limbs;
+        res.round(false);
+    }
+    res.limbs = precision_limbs;
+
+    return res;
+}
+
+void BigFloat::quotient(const BigInteger &numerator, const BigInteger &denominator)
+{
+    // Scale the dividend so that the quotient carries at least one limb
+    // more than the precision; a non-zero remainder only acts as sticky.
+    const exponent_type scale(std::max<exponent_type>(0, exponent_type(limbs) + 2
+        + exponent_type(denominator.repres.size()) - exponent_type(numerator.repres.size())));
+    BigInteger remainder;
+    mantissa = numerator;
+    shift(mantissa, std::size_t(scale));
+    mantissa.divide(denominator, remainder);
+    exponent = -scale;
+    round(!remainder.repres.empty());
+}
+
+BigFloat &BigFloat::add(const BigFloat &obj, const bool subtract)
+{
+    const bool obj_negative(obj.negative != subtract);
+    if (obj.is_zero())
+    {
+        round(false);
+        return *this;
+    }
+    if (is_zero())
+    {
+        const std::size_t precision_limbs(limbs), precision_digits(decimal_digits);
+        *this = obj.rounded(precision_limbs);
+        decimal_digits = precision_digits;
+        negative = obj_negative;
+        return *this;
+    }
+
+    const BigFloat rhs(obj.rounded(limbs));
+    round(false);
+    const exponent_type base(std::max(top(), rhs.top()) - exponent_type(limbs) - 2);
+    BigInteger lhs_m(aligned(base)), rhs_m(rhs.aligned(base));
+
+    if (negative == obj_negative)
+    {
+        lhs_m += rhs_m;
+    }
+    else if (lhs_m >= rhs_m)
+    {
+        lhs_m -= rhs_m;
+    }
+    else
+    {
+        rhs_m -= lhs_m;
+        lhs_m = std::move(rhs_m);
+        negative = obj_negative;
+    }
+    mantissa = std::move(lhs_m);
+    exponent = base - 1;
+    round(false);
+
+    return *this;
+}
+
+int BigFloat::compare_magnitude(const BigFloat &obj) const noexcept
+{
+    if (is_zero() || obj.is_zero())
+    {
+        return int(!is_zero()) - int(!obj.is_zero());
+    }
+    if (top() != obj.top())
+    {
+        return top() < obj.top() ? -1 : 1;
+    }
+
+    auto it(mantissa.repres.crbegin()), end(mantissa.repres.crend());
+    auto op_it(obj.mantissa.repres.crbegin()), op_end(obj.mantissa.repres.crend());
+    for (; it != end && op_it != op_end; ++it, ++op_it)
+    {
+        if (*it != *op_it)
+        {
+            return *it < *op_it ? -1 : 1;
+        }
+    }
+
+    return int(it != end) - int(op_it != op_end);
+}
+
+int BigFloat::compare(const BigFloat &obj) const noexcept
+{
+    if (negative != obj.negative)
+    {
+        return negative ? -1 : 1;
+    }
+
+    const int res(compare_magnitude(obj));
+    return negative ? -res : res;
+}
+
+BigFloat::BigFloat() : BigFloat(BigInteger(), default_digits().load(std::memory_order_relaxed))
+{
+}
+
+BigFloat::BigFloat(const BigInteger &obj) : BigFloat(obj, default_digits().load(std::memory_order_relaxed))
+{
+}
+
+BigFloat::BigFloat(const BigInteger &obj, const std::size_t digits) : mantissa(obj), exponent(0), limbs(digits_to_limbs(digits)), decimal_digits(digits), negative(false)
+{
+    round(false);
+}
+
+std::size_t BigFloat::default_precision() noexcept
+{
+    return default_digits().load(std::memory_order_relaxed);
+}
+
+void BigFloat::set_default_precision(const std::size_t digits) noexcept
+{
+    default_digits().store(digits, std::memory_order_relaxed);
+}
+
+std::size_t BigFloat::precision() const noexcept
+{
+    return decimal_digits;
+}
+
+BigFloat &BigFloat::set_precision(const std::size_t digits)
+{
+    limbs = digits_to_limbs(digits);
+    decimal_digits = digits;
+    round(false);
+
+    return *this;
+}
+
+bool BigFloat::operator<(const BigFloat &obj) const noexcept
+{
+    return compare(obj) < 0;
+}
+
+bool BigFloat::operator<=(const BigFloat &obj) const noexcept
+{
+    return compare(obj) <= 0;
+}
+
+bool BigFloat::operator==(const BigFloat &obj) const noexcept
+{
+    return compare(obj) == 0;
+}
+
+bool BigFloat::operator>=(const BigFloat &obj) const noexcept
+{
+    return compare(obj) >= 0;
+}
+
+bool BigFloat::operator>(const BigFloat &obj) const noexcept
+{
+    return compare(obj) > 0;
+}
+
+BigFloat BigFloat::operator-() const
+{
+    BigFloat res(*this);
+    if (!res.is_zero())
+    {
+        res.negative = !res.negative;
+    }
+
+    return res;
+}
+
+BigFloat &BigFloat::operator+=(const BigFloat &obj)
+{
+    return add(obj, false);
+}
+
+BigFloat &BigFloat::operator-=(const BigFloat &obj)
+{
+    return add(obj, true);
+}
+
+BigFloat &BigFloat::operator*=(const BigFloat &obj)
+{
+    const BigFloat rhs(obj.rounded(limbs));
+    round(false);
+
+    mantissa *= rhs.mantissa;
+    exponent += rhs.exponent;
+    negative = negative != rhs.negative;
+    round(false);
+
+    return *this;
+}
+
+BigFloat &BigFloat::operator/=(const BigFloat &obj)
+{
+    if (obj.is_zero())
+    {
+        throw std::overflow_error("Division by zero");
+    }
+
+    const BigFloat rhs(obj.rounded(limbs));
+    round(false);
+    if (is_zero())
+    {
+        return *this;
+    }
+
+    const exponent_type base(exponent - rhs.exponent);
+    const bool is_negative(negative != rhs.negative);
+    quotient(mantissa, rhs.mantissa);
+    exponent += base;
+    negative = is_negative;
+
+    return *this;
+}
+
+BigFloat BigFloat::operator+(const BigFloat &obj) const
+{
+    BigFloat res(*this);
+    res.limbs = std::max(limbs, obj.limbs);
+    res.decimal_digits = std::max(decimal_digits, obj.decimal_digits);
+    res += obj;
+
+    return res;
+}
+
+BigFloat BigFloat::operator-(const BigFloat &obj) const
+{
+    BigFloat res(*this);
+    res.limbs = std::max(limbs, obj.limbs);
+    res.decimal_digits = std::max(decimal_digits, obj.decimal_digits);
+    res -= obj;
+
+    return res;
+}
+
+BigFloat BigFloat::operator*(const BigFloat &obj) const
+{
+    BigFloat res(*this);
+    res.limbs = std::max(limbs, obj.limbs);
+    res.decimal_digits = std::max(decimal_digits, obj.decimal_digits);
+    res *= obj;
+
+    return res;
+}
+
+BigFloat BigFloat::operator/(const BigFloat &obj) const
+{
+    BigFloat res(*this);
+    res.limbs = std::max(limbs, obj.limbs);
+    res.decimal_digits = std::max(decimal_digits, obj.decimal_digits);
+    res /= obj;
+
+    return res;
+}
+
+BigFloat BigFloat::root() const
+{
+    if (negative)
+    {
+        throw std::range_error("Square root of a negative value");
+    }
+
+    BigFloat res(*this);
+    if (res.is_zero())
+    {
+        return res;
+    }
+
+    exponent_type scale(std::max<exponent_type>(0,
+        2 * (exponent_type(res.limbs) + 2) - exponent_type(res.mantissa.repres.size())));
+    if ((res.exponent - scale) % 2)
+    {
+        ++scale;
+    }
+    shift(res.mantissa, std::size_t(scale));
+    res.exponent -= scale;
+
+    const BigInteger root(sqrt(res.mantissa));
+    const bool sticky(!(root * root == res.mantissa));
+    res.mantissa = root;
+    res.exponent /= 2;
+    res.round(sticky);
+
+    return res;
+}
+
+BigFloat sqrt(const BigFloat &obj)
+{
+    return obj.root();
+}
+
+void BigFloat::write(std::ostream &stream) const
+{
+    if (is_zero())
+    {
+        stream << '0';
+        return;
+    }
+    if (negative)
+    {
+        stream << '-';
+    }
+
+    // The value is numerator / denominator exactly. Scale it by 10^scale so
+    // that its integer part has precision() digits, starting from the
+    // estimate of the decimal exponent the top limbs give.
+    BigInteger numerator(mantissa), denominator(1u);
+    shift(exponent >= 0 ? numerator : denominator, std::size_t(exponent >= 0 ? exponent : -exponent));
+    static const double limb_digits(std::log10(double(BigInteger::RADIX)));
+    const BigInteger::Limbs &repres(mantissa.repres);
+    const double lead(double(repres.back()) + (repres.size() > 1u ? double(repres[repres.size() - 2u]) / double(BigInteger::RADIX) : 0.));
+    const std::size_t digits(std::max<std::size_t>(precision(), 1u));
+    exponent_type scale(exponent_type(digits) - 1 - exponent_type(std::floor(std::log10(lead) + double(top() - 1) * limb_digits)));
+
+    BigInteger quotient, divisor, remainder;
+    std::string text;
+    while (true)
+    {
+        const BigInteger factor(power(BigInteger(10u), BigInteger(std::size_t(scale >= 0 ? scale : -scale))));
+        quotient = scale >= 0 ? numerator * factor : numerator;
+        divisor = scale >= 0 ? denominator : denominator * factor;
+        quotient.divide(divisor, remainder);
+
+        std::ostringstream buffer;
+        buffer << quotient;
+        text = quotient.repres.empty() ? std::string() : buffer.str();
+        if (text.size() == digits)
+        {
+            break;
+        }
+        scale += text.size() < digits ? 1 : -1;
+    }
+
+    // Round half to even; a carry out of the top digit gives 10^digits.
+    remainder += remainder;
+    if (divisor < remainder || (remainder == divisor && (text.back() - '0') % 2))
+    {
+        std::string::size_type k(text.size());
+        while (k > 0u && text[k - 1u] == '9')
+        {
+            text[--k] = '0';
+        }
+        if (k > 0u)
+        {
+            ++text[k - 1u];
+        }
+        else
+        {
+            text.insert(0u, 1u, '1');
+            text.pop_back();
+            --scale;
+        }
+    }
+    while (text.size() > 1u && text.back() == '0')
+    {
+        text.pop_back();
+        --scale;
+    }
+
+    if (scale <= 0)
+    {
+        stream << text << std::string(std::size_t(-scale), '0');
+    }
+    else if (std::size_t(scale) >= text.size())
+    {
+        stream << "0." << std::string(std::size_t(scale) - text.size(), '0') << text;
+    }
+    else
+    {
+        const std::size_t point(text.size() - std::size_t(scale));
+        stream << text.substr(0u, point) << '.' << text.substr(point);
+    }
+}
+
+std::ostream &operator<<(std::ostream &stream, const BigFloat &obj)
+{
+    obj.write(stream);
+
+    return stream;
+}
+
+std::istream &operator>>(std::istream &stream, BigFloat &obj)
+{
+    std::string buffer;
+    stream >> buffer;
+
+    const bool is_negative(!buffer.empty() && buffer.front() == '-');
+    std::string digits(buffer.substr(is_negative));
+    const std::string::size_type point(digits.find('.'));
+    std::size_t fraction_digits(0u);
+    if (point != std::string::npos)
+    {
+        fraction_digits = digits.size() - point - 1u;
+        digits.erase(point, 1u);
+    }
+
+    std::istringstream digit_stream(digits);
+    BigInteger value;
+    digit_stream >> value;
+
+    obj = BigFloat();
+    if (fraction_digits)
+    {
+        obj.quotient(value, power(BigInteger(10u), BigInteger(fraction_digits)));
+    }
+    else
+    {
+        obj.mantissa = std::move(value);
+        obj.round(false);
+    }
+    obj.negative = is_negative && !obj.is_zero();
+
+    return stream;
+}
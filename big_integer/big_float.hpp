@@ -0,0 +1,96 @@
+#ifndef _BIG_FLOAT_H_
+#define _BIG_FLOAT_H_
+
+#include <atomic>
+#include <iostream>
+
+#include "./big_integer.hpp"
+
+// Signed value mantissa * RADIX^exponent with the mantissa rounded to a
+// fixed number of limbs. Every operation rounds half to even at limb
+// granularity; operands longer than the working precision are rounded to it
+// first, so a product of p-limb values costs a single p-limb multiplication.
+// The limbs hold at least the requested number of decimal digits, which is
+// what precision() reports and how many significant digits are printed.
+class BigFloat
+{
+public:
+    typedef long long exponent_type;
+
+private:
+    typedef BigInteger::Integer Integer;
+
+    BigInteger mantissa;
+    exponent_type exponent;
+    std::size_t limbs;
+    std::size_t decimal_digits;
+    bool negative;
+
+    static std::atomic<std::size_t> &default_digits();
+    static std::size_t digits_to_limbs(std::size_t);
+    static void shift(BigInteger &, std::size_t);
+
+    bool is_zero() const noexcept;
+    exponent_type top() const noexcept;
+    void round(bool);
+    BigInteger aligned(exponent_type) const;
+    BigFloat rounded(std::size_t) const;
+    void quotient(const BigInteger &, const BigInteger &);
+    BigFloat &add(const BigFloat &, bool);
+    int compare_magnitude(const BigFloat &) const noexcept;
+    int compare(const BigFloat &) const noexcept;
+    BigFloat root() const;
+    void write(std::ostream &) const;
+
+public:
+    BigFloat();
+    BigFloat(const BigInteger &);
+    BigFloat(const BigInteger &, std::size_t);
+    BigFloat(const BigFloat &) = default;
+    BigFloat(BigFloat &&) noexcept = default;
+
+    ~BigFloat() = default;
+
+    BigFloat &operator=(const BigFloat &) = default;
+    BigFloat &operator=(BigFloat &&) noexcept = default;
+
+    static std::size_t default_precision() noexcept;
+    static void set_default_precision(std::size_t) noexcept;
+
+    std::size_t precision() const noexcept;
+    BigFloat &set_precision(std::size_t);
+
+    bool operator<(const BigFloat &) const noexcept;
+    bool operator<=(const BigFloat &) const noexcept;
+    bool operator==(const BigFloat &) const noexcept;
+    bool operator>=(const BigFloat &) const noexcept;
+    bool operator>(const BigFloat &) const noexcept;
+
+    BigFloat operator-() const;
+
+    BigFloat &operator+=(const BigFloat &);
+    BigFloat &operator-=(const BigFloat &);
+    BigFloat &operator*=(const BigFloat &);
+    BigFloat &operator/=(const BigFloat &);
+
+    BigFloat operator+(const BigFloat &) const;
+    BigFloat operator-(const BigFloat &) const;
+    BigFloat operator*(const BigFloat &) const;
+    BigFloat operator/(const BigFloat &) const;
+    friend BigFloat sqrt(const BigFloat &);
+
+    friend std::ostream &operator<<(std::ostream &, const BigFloat &);
+    friend std::istream &operator>>(std::istream &, BigFloat &);
+};
+
+inline bool BigFloat::is_zero() const noexcept
+{
+    return mantissa.repres.empty();
+}
+
+inline BigFloat::exponent_type BigFloat::top() const noexcept
+{
+    return exponent + exponent_type(mantissa.repres.size());
+}
+
+#endif
@@ -0,0 +1,942 @@
+#include <bitset>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+#include "./big_integer.hpp"
+#include "./kernels.hpp"
+
+constexpr const BigInteger::Integer BigInteger::RADIX;
+constexpr const BigInteger::Integer BigInteger::DECIMAL_RADIX;
+
+big_integer_kernels::Multiply big_integer_kernels::multiply(&big_integer_kernels::generic::multiply);
+
+// Runs during static initialization; until then the generic kernel is used.
+static struct KernelSelection
+{
+    KernelSelection()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw")
+            && __builtin_cpu_supports("avx512vl"))
+        {
+            big_integer_kernels::multiply = &big_integer_kernels::skylake_avx512::multiply;
+        }
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma"))
+        {
+            big_integer_kernels::multiply = &big_integer_kernels::haswell::multiply;
+        }
+#endif
+    }
+} kernel_selection;
+
+BigInteger BigInteger::from_limbs(const Integer *limbs, std::size_t size)
+{
+    BigInteger res;
+    res.repres.assign(limbs, limbs + size);
+
+    return res;
+}
+
+// 10^(DIGITS * 2^level), squared up from 10^9 on first use and kept; the
+// deque never moves the powers already handed out.
+const BigInteger &BigInteger::decimal_power(const std::size_t level)
+{
+    static std::mutex mutex;
+    static std::deque<BigInteger> powers(1u, BigInteger(DECIMAL_RADIX));
+    std::lock_guard<std::mutex> lock(mutex);
+    while (powers.size() <= level)
+    {
+        powers.push_back(powers.back() * powers.back());
+    }
+
+    return powers[level];
+}
+
+// The value of the base 10^9 digits chunks[first, first + 2^level), least
+// significant first: high * 10^(DIGITS * 2^(level - 1)) + low.
+BigInteger BigInteger::from_decimal(const std::vector<Integer> &chunks, const std::size_t first, const std::size_t level)
+{
+    const std::size_t last(std::min(chunks.size(), first + (std::size_t(1u) << level)));
+    BigInteger res;
+    if (level <= DECIMAL_LEVEL)
+    {
+        // Fold the chunks in with a single-limb multiply-add each.
+        for (std::size_t k = last; k-- > first;)
+        {
+            res *= DECIMAL_RADIX;
+            res += chunks[k];
+        }
+        return res;
+    }
+
+    const std::size_t middle(first + (std::size_t(1u) << (level - 1u)));
+    res = from_decimal(chunks, first, level - 1u);
+    if (middle < last)
+    {
+        res += from_decimal(chunks, middle, level - 1u) * decimal_power(level - 1u);
+    }
+
+    return res;
+}
+
+BigInteger &BigInteger::operator+=(const Integer &obj)
+{
+    if (!obj)
+    {
+        return *this;
+    }
+    if (repres.empty())
+    {
+        repres.push_back(obj);
+    }
+    else
+    {
+        repres.front() += obj;
+    }
+
+    register Integer carry(0u);
+    for (auto it(repres.begin()), end(repres.end()); it != end; ++it)
+    {
+        *it += carry;
+        if (*it >= RADIX)
+        {
+            carry = 1u;
+            *it %= RADIX;
+        }
+        else
+        {
+            carry = 0u;
+            break;
+        }
+    }
+    if (carry)
+    {
+        repres.push_back(1u);
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator-=(const Integer &obj)
+{
+    if (!obj)
+    {
+        return *this;
+    }
+    else if (repres.empty() || (repres.size() == 1u && repres.front() < obj))
+    {
+        throw std::range_error("Unsigned subtraction yielding a negative value");
+    }
+
+    repres.front() -= obj;
+    register Integer carry(0u);
+    for (auto it(repres.begin()), end(repres.end()); it != end; ++it)
+    {
+        *it -= carry;
+        if (*it >= RADIX)
+        {
+            carry = 1u;
+            *it += RADIX;
+        }
+        else
+        {
+            carry = 0;
+            break;
+        }
+    }
+    if (!repres.back())
+    {
+        repres.pop_back();
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator*=(const Integer &obj)
+{
+    if (repres.empty())
+    {
+        return *this;
+    }
+    else if (!obj)
+    {
+        this->repres.clear();
+        return *this;
+    }
+
+    Integer carry(0u);
+    for (auto i_it(repres.begin()), i_end(repres.end()); i_it != i_end; ++i_it)
+    {
+        *i_it *= obj;
+        *i_it += carry;
+        carry = *i_it / RADIX;
+        *i_it %= RADIX;
+    }
+    if (carry)
+    {
+        repres.push_back(carry);
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator/=(const Integer &obj)
+{
+    if (!obj)
+    {
+        throw std::overflow_error("Division by zero");
+    }
+    if (repres.empty() || obj == 1u)
+    {
+        return *this;
+    }
+    else if (repres.size() == 1u)
+    {
+        repres.front() /= obj;
+        if (!repres.front())
+        {
+            repres.clear();
+        }
+        return *this;
+    }
+
+    register Integer remainder(0u);
+    for (auto i_it(repres.rbegin()), i_end(repres.rend()); i_it != i_end; ++i_it)
+    {
+        remainder *= RADIX;
+        remainder += *i_it;
+        *i_it = remainder / obj;
+        remainder %= obj;
+    }
+    if (!repres.back())
+    {
+        repres.pop_back();
+    }
+
+    return *this;
+}
+
+BigInteger BigInteger::operator+(const Integer &obj) const
+{
+    BigInteger res(*this);
+    res += obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator-(const Integer &obj) const
+{
+    BigInteger res(*this);
+    res -= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator*(const Integer &obj) const
+{
+    BigInteger res(*this);
+    res *= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator/(const Integer &obj) const
+{
+    BigInteger res(*this);
+    res /= obj;
+
+    return res;
+}
+
+std::size_t BigInteger::bit_length() const noexcept
+{
+    if (repres.empty())
+    {
+        return 0u;
+    }
+
+    std::size_t res((repres.size() - 1u) * BITS);
+    for (Integer top(repres.back()); top; top >>= 1u)
+    {
+        ++res;
+    }
+
+    return res;
+}
+
+std::size_t BigInteger::popcount() const noexcept
+{
+    std::size_t res(0u);
+    for (const Integer limb : repres)
+    {
+        res += std::bitset<BITS>(limb).count();
+    }
+
+    return res;
+}
+
+BigInteger &BigInteger::operator++()
+{
+    *this += Integer(1u);
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator--()
+{
+    *this -= Integer(1u);
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator+=(const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(ADD, std::max(repres.size(), obj.repres.size()));
+    if (obj.repres.empty())
+    {
+        BIG_INTEGER_TIER(TRIVIAL);
+        return *this;
+    }
+    else if (obj.repres.size() == 1u)
+    {
+        BIG_INTEGER_TIER(SINGLE_LIMB);
+        *this += obj.repres.front();
+        return *this;
+    }
+    auto it(repres.begin()), end(repres.end());
+    auto op_it(obj.repres.cbegin()), op_end(obj.repres.cend());
+    register Integer carry(0u);
+    for (; it != end; ++it)
+    {
+        if (op_it != op_end)
+        {
+            *it += *op_it + carry;
+            ++op_it;
+        }
+        else if (carry)
+        {
+            *it += carry;
+        }
+        else
+        {
+            break;
+        }
+        if (*it >= RADIX)
+        {
+            carry = 1u;
+            *it %= RADIX;
+        }
+        else
+        {
+            carry = 0u;
+        }
+    }
+    for (; op_it != op_end; ++op_it)
+    {
+        repres.push_back(*op_it + carry);
+        if (repres.back() >= RADIX)
+        {
+            carry = 1u;
+            repres.back() %= RADIX;
+        }
+        else
+        {
+            carry = 0u;
+        }
+    }
+    if (carry)
+    {
+        repres.push_back(1u);
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator-=(const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(SUBTRACT, std::max(repres.size(), obj.repres.size()));
+    if (obj.repres.empty())
+    {
+        BIG_INTEGER_TIER(TRIVIAL);
+        return *this;
+    }
+    else if (obj.repres.size() == 1u)
+    {
+        BIG_INTEGER_TIER(SINGLE_LIMB);
+        *this -= obj.repres.front();
+        return *this;
+    }
+    else if (repres.size() < obj.repres.size())
+    {
+        throw std::range_error("Unsigned subtraction yielding a negative value");
+    }
+
+    auto it(repres.begin()), end(repres.end());
+    auto op_it(obj.repres.cbegin()), op_end(obj.repres.cend());
+    auto all_zero(end);
+    register Integer carry(0u);
+    for (; it != end; ++it)
+    {
+        if (op_it != op_end)
+        {
+            *it -= *op_it + carry;
+            ++op_it;
+        }
+        else if (carry)
+        {
+            *it -= carry;
+        }
+        else
+        {
+            all_zero = end;
+            break;
+        }
+        if (*it >= RADIX)
+        {
+            carry = 1u;
+            *it += RADIX;
+        }
+        else
+        {
+            carry = 0;
+        }
+        if (*it)
+        {
+            all_zero = end;
+        }
+        else if (all_zero == end)
+        {
+            all_zero = it;
+        }
+    }
+    if (carry)
+    {
+        throw std::range_error("Unsigned subtraction yielding a negative value");
+    }
+    if (all_zero != end)
+    {
+        repres.resize(all_zero - repres.begin());
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator*=(const BigInteger &obj)
+{
+    *this = *this * obj;
+    return *this;
+}
+
+BigInteger &BigInteger::divide(const BigInteger &obj, BigInteger &remainder)
+{
+    BIG_INTEGER_SCOPE(DIVIDE, repres.size());
+    if (obj.repres.empty())
+    {
+        throw std::overflow_error("Division by zero");
+    }
+    if (repres.size() < obj.repres.size() || (repres.size() == obj.repres.size() && repres.back() < obj.repres.back()))
+    {
+        BIG_INTEGER_TIER(TRIVIAL);
+        remainder.repres.swap(repres);
+        this->repres.clear();
+        return *this;
+    }
+    if (obj.repres.size() == 1u)
+    {
+        BIG_INTEGER_TIER(SINGLE_LIMB);
+        std::vector<Integer> rem;
+        remainders(obj.repres, rem);
+        *this /= obj.repres.front();
+        remainder.repres.clear();
+        if (rem.front())
+        {
+            remainder.repres.push_back(rem.front());
+        }
+        return *this;
+    }
+
+    BigInteger v(obj);
+    Integer norm(1u);
+    if (v.repres.back() < HALF_OF_RADIX)
+    {
+        norm = RADIX / (v.repres.back() + 1u);
+        *this *= norm;
+        v *= norm;
+    }
+
+    BigInteger q, sub;
+    remainder.repres.clear();
+    q.repres.resize(repres.size() - obj.repres.size() + 1u);
+    remainder.repres.resize(v.repres.size() - 1u);
+    std::copy(repres.crbegin(), repres.crbegin() + remainder.repres.size(), remainder.repres.rbegin());
+
+    register const Integer v_n__1(v.repres.back()), v_n__2(*(v.repres.crbegin() + 1u));
+    register const std::size_t n(v.repres.size());
+    auto i_it(repres.crbegin() + remainder.repres.size());
+    auto zero_it(q.repres.crbegin());
+    bool is_find_non_zero = false;
+    const BigInteger radix(RADIX);
+    for (auto j_it(q.repres.rbegin()), j_end(q.repres.rend()); j_it != j_end; ++i_it, ++j_it)
+    {
+        remainder *= radix;
+        remainder += *i_it;
+
+        register const Integer u_n(remainder.get(n)), u_n__1(remainder.get(n - 1u)), u_n__2(remainder.get(n - 2u));
+        Integer q_approxim((u_n * RADIX + u_n__1) / v_n__1), r_approxim((u_n * RADIX + u_n__1) % v_n__1);
+
+        while ((r_approxim < RADIX) && ((q_approxim >= RADIX) || (q_approxim * v_n__2 > RADIX * r_approxim + u_n__2)))
+        {
+            --q_approxim;
+            r_approxim += v_n__1;
+        }
+        sub = v * q_approxim;
+        if (remainder < v * q_approxim)
+        {
+            --q_approxim;
+            sub -= v;
+        }
+        *j_it = q_approxim;
+        remainder -= sub;
+
+        if (*j_it)
+        {
+            is_find_non_zero = true;
+        }
+        else if (!is_find_non_zero)
+        {
+            ++zero_it;
+        }
+    }
+    if (zero_it != q.repres.crbegin())
+    {
+        q.repres.resize(q.repres.crend() - zero_it);
+    }
+
+    *this = std::move(q);
+    remainder /= norm;
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator/=(const BigInteger &obj)
+{
+    BigInteger remainder;
+
+    return divide(obj, remainder);
+}
+
+BigInteger &BigInteger::operator%=(const BigInteger &obj)
+{
+    BigInteger remainder;
+    divide(obj, remainder);
+    repres.swap(remainder.repres);
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator<<=(std::size_t count)
+{
+    BIG_INTEGER_SCOPE(SHIFT, repres.size());
+    if (repres.empty() || !count)
+    {
+        return *this;
+    }
+
+    const std::size_t limbs(count / BITS), bits(count % BITS), old_size(repres.size());
+    repres.resize(old_size + limbs + 1u);
+    if (bits)
+    {
+        repres[old_size + limbs] = repres[old_size - 1u] >> (BITS - bits);
+        for (std::size_t i = old_size - 1u; i > 0u; --i)
+        {
+            repres[i + limbs] = ((repres[i] << bits) & MASK) | (repres[i - 1u] >> (BITS - bits));
+        }
+        repres[limbs] = (repres.front() << bits) & MASK;
+    }
+    else
+    {
+        repres[old_size + limbs] = 0u;
+        std::copy_backward(repres.begin(), repres.begin() + old_size, repres.begin() + old_size + limbs);
+    }
+    std::fill(repres.begin(), repres.begin() + limbs, 0u);
+    if (!repres.back())
+    {
+        repres.pop_back();
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator>>=(std::size_t count)
+{
+    BIG_INTEGER_SCOPE(SHIFT, repres.size());
+    const std::size_t limbs(count / BITS), bits(count % BITS);
+    if (limbs >= repres.size())
+    {
+        repres.clear();
+        return *this;
+    }
+
+    const std::size_t new_size(repres.size() - limbs);
+    if (bits)
+    {
+        for (std::size_t i = 0u; i + 1u < new_size; ++i)
+        {
+            repres[i] = (repres[i + limbs] >> bits) | ((repres[i + limbs + 1u] << (BITS - bits)) & MASK);
+        }
+        repres[new_size - 1u] = repres.back() >> bits;
+    }
+    else
+    {
+        std::copy(repres.begin() + limbs, repres.end(), repres.begin());
+    }
+    repres.resize(new_size);
+    if (!repres.back())
+    {
+        repres.pop_back();
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator&=(const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(BITWISE, std::max(repres.size(), obj.repres.size()));
+    if (repres.size() > obj.repres.size())
+    {
+        repres.resize(obj.repres.size());
+    }
+    for (std::size_t i = 0u; i < repres.size(); ++i)
+    {
+        repres[i] &= obj.repres[i];
+    }
+    while (!repres.empty() && !repres.back())
+    {
+        repres.pop_back();
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator|=(const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(BITWISE, std::max(repres.size(), obj.repres.size()));
+    if (repres.size() < obj.repres.size())
+    {
+        repres.resize(obj.repres.size());
+    }
+    for (std::size_t i = 0u; i < obj.repres.size(); ++i)
+    {
+        repres[i] |= obj.repres[i];
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator^=(const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(BITWISE, std::max(repres.size(), obj.repres.size()));
+    if (repres.size() < obj.repres.size())
+    {
+        repres.resize(obj.repres.size());
+    }
+    for (std::size_t i = 0u; i < obj.repres.size(); ++i)
+    {
+        repres[i] ^= obj.repres[i];
+    }
+    while (!repres.empty() && !repres.back())
+    {
+        repres.pop_back();
+    }
+
+    return *this;
+}
+
+BigInteger &power_eq(BigInteger &base, const BigInteger &exp)
+{
+    BIG_INTEGER_SCOPE(POWER, base.repres.size());
+    const BigInteger one(1u);
+    if (base.repres.empty())
+    {
+        if (exp.repres.empty())
+        {
+            throw std::range_error("Division by zero");
+        }
+        else
+        {
+            return base;
+        }
+    }
+    else if (base == one)
+    {
+        return base;
+    }
+    if (exp.repres.empty())
+    {
+        BIG_INTEGER_TIER(TRIVIAL);
+        base = one;
+        return base;
+    }
+    else if (exp == one)
+    {
+        return base;
+    }
+
+    BigInteger increm(1u), residue(exp);
+    do
+    {
+        if (residue.repres.front() & 1u)
+        {
+            increm *= base;
+            --residue;
+        }
+        else
+        {
+            base *= base;
+            residue >>= 1u;
+        }
+    } while (residue > one);
+    base *= increm;
+
+    return base;
+}
+
+BigInteger BigInteger::operator+(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res += obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator-(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res -= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator*(const BigInteger &obj) const
+{
+    BIG_INTEGER_SCOPE(MULTIPLY, std::max(repres.size(), obj.repres.size()));
+    if (repres.empty() || obj.repres.empty())
+    {
+        BIG_INTEGER_TIER(TRIVIAL);
+        return BigInteger();
+    }
+    else if (obj.repres.size() == 1u)
+    {
+        BIG_INTEGER_TIER(SINGLE_LIMB);
+        return *this * obj.repres.front();
+    }
+
+    const bool is_shorter(repres.size() < obj.repres.size());
+    const Limbs &lhs(is_shorter ? obj.repres : repres), &rhs(is_shorter ? repres : obj.repres);
+    BigInteger res;
+    res.repres.assign(repres.size() + obj.repres.size(), 0u);
+    big_integer_kernels::multiply(res.repres.data(), lhs.data(), lhs.size(), rhs.data(), rhs.size());
+
+    Integer carry(0u);
+    for (Integer &limb : res.repres)
+    {
+        carry += limb;
+        limb = carry & MASK;
+        carry >>= BITS;
+    }
+    if (!res.repres.back())
+    {
+        res.repres.pop_back();
+    }
+
+    return res;
+}
+
+BigInteger BigInteger::operator/(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res /= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator%(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res %= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator<<(std::size_t count) const
+{
+    BigInteger res(*this);
+    res <<= count;
+
+    return res;
+}
+
+BigInteger BigInteger::operator>>(std::size_t count) const
+{
+    BigInteger res(*this);
+    res >>= count;
+
+    return res;
+}
+
+BigInteger BigInteger::operator&(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res &= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator|(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res |= obj;
+
+    return res;
+}
+
+BigInteger BigInteger::operator^(const BigInteger &obj) const
+{
+    BigInteger res(*this);
+    res ^= obj;
+
+    return res;
+}
+
+BigInteger power(const BigInteger &base, const BigInteger &exp)
+{
+    BigInteger res(base);
+    power_eq(res, exp);
+
+    return res;
+}
+
+BigInteger sqrt(const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(SQRT, obj.repres.size());
+    if (obj.repres.empty())
+    {
+        return obj;
+    }
+
+    BigInteger x, y;
+    x.repres.resize((obj.repres.size() + 1u) / 2u + 1u);
+    x.repres.back() = 1u;
+    while (true)
+    {
+        y = obj / x;
+        y += x;
+        y /= BigInteger::Integer(2u);
+        if (y >= x)
+        {
+            return x;
+        }
+        x = std::move(y);
+    }
+}
+
+BigInteger gcd(const BigInteger &lhs, const BigInteger &rhs)
+{
+    BIG_INTEGER_SCOPE(GCD, std::max(lhs.repres.size(), rhs.repres.size()));
+    BigInteger a(lhs), b(rhs);
+    while (!b.repres.empty())
+    {
+        if (b.repres.size() == 1u)
+        {
+            std::vector<BigInteger::Integer> rem;
+            a.remainders(b.repres, rem);
+            BigInteger::Integer x(b.repres.front()), y(rem.front());
+            while (y)
+            {
+                x %= y;
+                std::swap(x, y);
+            }
+            a.repres.assign(1u, x);
+            return a;
+        }
+        a %= b;
+        a.repres.swap(b.repres);
+    }
+
+    return a;
+}
+
+std::ostream &operator<<(std::ostream &stream, const BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(OUTPUT, obj.repres.size());
+    if (obj.repres.empty())
+    {
+        stream << "0";
+
+        return stream;
+    }
+
+    // Peel off base 10^9 chunks by repeated single-limb division. This is
+    // quadratic in the length; splitting by the cached powers of 10^9 only
+    // pays once division is much faster than the schoolbook one.
+    BigInteger::Limbs temp(obj.repres);
+    std::vector<BigInteger::Integer> chunks;
+    while (!temp.empty())
+    {
+        BigInteger::Integer remainder(0u);
+        for (auto it(temp.rbegin()), end(temp.rend()); it != end; ++it)
+        {
+            remainder = remainder * BigInteger::RADIX + *it;
+            *it = remainder / BigInteger::DECIMAL_RADIX;
+            remainder %= BigInteger::DECIMAL_RADIX;
+        }
+        chunks.push_back(remainder);
+        if (!temp.back())
+        {
+            temp.pop_back();
+        }
+    }
+
+    stream << chunks.back();
+    for (auto it(chunks.crbegin() + 1u), end(chunks.crend()); it != end; ++it)
+    {
+        stream << std::setfill('0') << std::setw(BigInteger::DIGITS) << *it;
+    }
+
+    return stream;
+}
+
+std::istream &operator>>(std::istream &stream, BigInteger &obj)
+{
+    BIG_INTEGER_SCOPE(INPUT, 0u);
+
+    std::string buffer;
+    stream >> buffer;
+
+    // Base 10^9 chunks, least significant first.
+    std::vector<BigInteger::Integer> chunks;
+    for (std::string::size_type end = buffer.size(); end > 0u;)
+    {
+        const std::string::size_type begin(end > BigInteger::DIGITS ? end - BigInteger::DIGITS : 0u);
+        BigInteger::Integer chunk(0u);
+        for (std::string::size_type k = begin; k < end; ++k)
+        {
+            chunk = chunk * BigInteger::TEN + BigInteger::Integer(buffer[k] - '0');
+        }
+        chunks.push_back(chunk);
+        end = begin;
+    }
+
+    std::size_t level(0u);
+    while ((std::size_t(1u) << level) < chunks.size())
+    {
+        ++level;
+    }
+    obj = BigInteger::from_decimal(chunks, 0u, level);
+    BIG_INTEGER_LIMBS(obj.repres.size());
+
+    return stream;
+}
@@ -1,26 +1,54 @@
 #ifndef _BIG_INTEGER_H_
 #define _BIG_INTEGER_H_
 
+#include <algorithm>
 #include <iostream>
-#include <iomanip>
 #include <limits>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <utility>
 
+#include "./instrumentation.hpp"
+
 class BigInteger
 {
 private:
     typedef unsigned long long Integer;
+    typedef std::vector<Integer, big_integer_instrumentation::Allocator<Integer>> Limbs;
 
-    static constexpr const Integer RADIX = 1000000000ull;/*10ull*/
-    static constexpr const Integer HALF_OF_RADIX = 500000000ull;/*5ull*/
+    static constexpr const unsigned BITS = 32u;
+    static constexpr const Integer RADIX = 1ull << BITS;
+    static constexpr const Integer HALF_OF_RADIX = 1ull << (BITS - 1u);
+    static constexpr const Integer MASK = RADIX - 1u;
     static constexpr const unsigned TEN = 10u;
-    static constexpr const unsigned DIGITS = 9u;/*1u*/
+    static constexpr const unsigned DIGITS = 9u;
+    static constexpr const Integer DECIMAL_RADIX = 1000000000ull;
+    // Decimal input is combined at 10^(DIGITS * 2^k) down to blocks of
+    // 2^DECIMAL_LEVEL chunks, which are folded in chunk by chunk.
+    static constexpr const std::size_t DECIMAL_LEVEL = 5u;
+
+    Limbs repres;
 
-    std::vector<Integer> repres;
+    template <std::size_t N>
+    struct Literal
+    {
+        Integer limbs[N];
+        std::size_t size;
+    };
+
+    template <std::size_t N, char... Chars>
+    static constexpr Literal<N> parse_literal();
+    static constexpr Integer literal_digit(char);
+    static BigInteger from_limbs(const Integer *, std::size_t);
+    static const BigInteger &decimal_power(std::size_t);
+    static BigInteger from_decimal(const std::vector<Integer> &, std::size_t, std::size_t);
 
     Integer get(std::vector<BigInteger::Integer>::size_type) const;
+    template <typename T>
+    void remainders(const T &, std::vector<Integer> &) const;
+    BigInteger &divide(const BigInteger &, BigInteger &);
 
     BigInteger &operator+=(const Integer &);
     BigInteger &operator-=(const Integer &);
@@ -36,9 +64,9 @@ public:
     BigInteger();
     BigInteger(const BigInteger &);
     BigInteger(BigInteger &&) noexcept;
-    template <typename T>
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
     BigInteger(const T &);
-    template <typename T>
+    template <typename T, typename = typename std::enable_if<std::is_integral<typename std::decay<T>::type>::value>::type>
     BigInteger(T &&);
 
     ~BigInteger();
@@ -46,6 +74,11 @@ public:
     BigInteger &operator=(const BigInteger &);
     BigInteger &operator=(BigInteger &&);
 
+    std::size_t size() const noexcept;
+    std::size_t bit_length() const noexcept;
+    std::size_t popcount() const noexcept;
+    bool test_bit(std::size_t) const noexcept;
+
     bool operator<(const BigInteger &) const noexcept;
     bool operator<=(const BigInteger &) const noexcept;
     bool operator==(const BigInteger &) const noexcept;
@@ -59,21 +92,45 @@ public:
     BigInteger &operator-=(const BigInteger &);
     BigInteger &operator*=(const BigInteger &);
     BigInteger &operator/=(const BigInteger &);
+    BigInteger &operator%=(const BigInteger &);
+    BigInteger &operator<<=(std::size_t);
+    BigInteger &operator>>=(std::size_t);
+    BigInteger &operator&=(const BigInteger &);
+    BigInteger &operator|=(const BigInteger &);
+    BigInteger &operator^=(const BigInteger &);
     friend BigInteger &power_eq(BigInteger &, const BigInteger &);
 
     BigInteger operator+(const BigInteger &) const;
     BigInteger operator-(const BigInteger &) const;
     BigInteger operator*(const BigInteger &) const;
     BigInteger operator/(const BigInteger &) const;
+    BigInteger operator%(const BigInteger &) const;
+    BigInteger operator<<(std::size_t) const;
+    BigInteger operator>>(std::size_t) const;
+    BigInteger operator&(const BigInteger &) const;
+    BigInteger operator|(const BigInteger &) const;
+    BigInteger operator^(const BigInteger &) const;
     friend BigInteger power(const BigInteger &, const BigInteger &);
+    friend BigInteger sqrt(const BigInteger &);
+    friend BigInteger gcd(const BigInteger &, const BigInteger &);
+
+    friend class Montgomery;
+    friend class BigFloat;
+    friend class RandomBigInteger;
+    friend bool is_prime(const BigInteger &, unsigned);
+    friend BigInteger next_prime(const BigInteger &);
 
     friend std::ostream &operator<<(std::ostream &, const BigInteger &);
     friend std::istream &operator>>(std::istream &, BigInteger &);
+
+    template <char... Chars>
+    friend const BigInteger &operator"" _bi();
 };
 
-constexpr const BigInteger::Integer BigInteger::RADIX;
+template <char... Chars>
+const BigInteger &operator"" _bi();
 
-BigInteger::Integer BigInteger::get(std::vector<BigInteger::Integer>::size_type idx) const
+inline BigInteger::Integer BigInteger::get(std::vector<BigInteger::Integer>::size_type idx) const
 {
     if (idx >= repres.size())
     {
@@ -83,184 +140,87 @@ BigInteger::Integer BigInteger::get(std::vector<BigInteger::Integer>::size_type
     return repres[idx];
 }
 
-BigInteger &BigInteger::operator+=(const Integer &obj)
+constexpr BigInteger::Integer BigInteger::literal_digit(char c)
 {
-    if (!obj)
-    {
-        return *this;
-    }
-    if (repres.empty())
-    {
-        repres.push_back(obj);
-    }
-    else
-    {
-        repres.front() += obj;
-    }
+    return c >= '0' && c <= '9' ? Integer(c - '0') : (c >= 'a' && c <= 'f' ? Integer(c - 'a' + 10) : Integer(c - 'A' + 10));
+}
 
-    register Integer carry(0u);
-    for (auto it(repres.begin()), end(repres.end()); it != end; ++it)
+// Accepts everything the language allows in an integer literal: decimal,
+// 0x hexadecimal, 0b binary and 0 octal, with ' digit separators.
+template <std::size_t N, char... Chars>
+constexpr BigInteger::Literal<N> BigInteger::parse_literal()
+{
+    const char text[] = {Chars...};
+    std::size_t pos(0u);
+    Integer base(TEN);
+    if (sizeof...(Chars) > 1u && text[0] == '0')
     {
-        *it += carry;
-        if (*it >= RADIX)
+        if (text[1] == 'x' || text[1] == 'X')
         {
-            carry = 1u;
-            *it %= RADIX;
+            base = 16u;
+            pos = 2u;
+        }
+        else if (text[1] == 'b' || text[1] == 'B')
+        {
+            base = 2u;
+            pos = 2u;
         }
         else
         {
-            carry = 0u;
-            break;
+            base = 8u;
+            pos = 1u;
         }
     }
-    if (carry)
-    {
-        repres.push_back(1u);
-    }
-
-    return *this;
-}
-
-BigInteger &BigInteger::operator-=(const Integer &obj)
-{
-    if (!obj)
-    {
-        return *this;
-    }
-    else if (repres.empty() || (repres.size() == 1u && repres.front() < obj))
-    {
-        throw std::range_error("Unsigned subtraction yielding a negative value");
-    }
 
-    repres.front() -= obj;
-    register Integer carry(0u);
-    for (auto it(repres.begin()), end(repres.end()); it != end; ++it)
+    Literal<N> res{};
+    for (; pos < sizeof...(Chars); ++pos)
     {
-        *it -= carry;
-        if (*it >= RADIX)
+        if (text[pos] == '\'')
         {
-            carry = 1u;
-            *it += RADIX;
+            continue;
         }
-        else
+        Integer carry(literal_digit(text[pos]));
+        for (std::size_t i = 0u; i < res.size; ++i)
         {
-            carry = 0;
-            break;
+            carry += res.limbs[i] * base;
+            res.limbs[i] = carry & MASK;
+            carry >>= BITS;
+        }
+        if (carry)
+        {
+            res.limbs[res.size++] = carry;
         }
-    }
-    if (!repres.back())
-    {
-        repres.pop_back();
-    }
-
-    return *this;
-}
-
-BigInteger &BigInteger::operator*=(const Integer &obj)
-{
-    if (repres.empty())
-    {
-        return *this;
-    }
-    else if (!obj)
-    {
-        this->repres.clear();
-        return *this;
-    }
-
-    Integer carry(0u);
-    for (auto i_it(repres.begin()), i_end(repres.end()); i_it != i_end; ++i_it)
-    {
-        *i_it *= obj;
-        *i_it += carry;
-        carry = *i_it / RADIX;
-        *i_it %= RADIX;
-    }
-    if (carry)
-    {
-        repres.push_back(carry);
     }
 
-    return *this;
+    return res;
 }
 
-BigInteger &BigInteger::operator/=(const Integer &obj)
+template <typename T>
+void BigInteger::remainders(const T &moduli, std::vector<Integer> &res) const
 {
-    if (!obj)
+    res.assign(moduli.size(), 0u);
+    for (auto it(repres.crbegin()), end(repres.crend()); it != end; ++it)
     {
-        throw std::overflow_error("Division by zero");
-    }
-    if (repres.empty() || obj == 1u)
-    {
-        return *this;
-    }
-    else if (repres.size() == 1u)
-    {
-        repres.front() /= obj;
-        return *this;
-    }
-
-    register Integer remainder(0u);
-    for (auto i_it(repres.rbegin()), i_end(repres.rend()); i_it != i_end; ++i_it)
-    {
-        remainder *= RADIX;
-        remainder += *i_it;
-        *i_it = remainder / obj;
-        remainder %= obj;
-    }
-    if (!repres.back())
-    {
-        repres.pop_back();
+        for (typename T::size_type k = 0u; k < moduli.size(); ++k)
+        {
+            res[k] = (res[k] * RADIX + *it) % moduli[k];
+        }
     }
-
-    return *this;
-}
-
-BigInteger BigInteger::operator+(const Integer &obj) const
-{
-    BigInteger res(*this);
-    res += obj;
-
-    return res;
 }
 
-BigInteger BigInteger::operator-(const Integer &obj) const
+inline BigInteger::BigInteger() : repres()
 {
-    BigInteger res(*this);
-    res -= obj;
-
-    return res;
-}
-
-BigInteger BigInteger::operator*(const Integer &obj) const
-{
-    BigInteger res(*this);
-    res *= obj;
-
-    return res;
 }
 
-BigInteger BigInteger::operator/(const Integer &obj) const
+inline BigInteger::BigInteger(const BigInteger &obj) : repres(obj.repres)
 {
-    BigInteger res(*this);
-    res /= obj;
-
-    return res;
 }
 
-BigInteger::BigInteger() : repres()
+inline BigInteger::BigInteger(BigInteger &&obj) noexcept : repres(std::move(obj.repres))
 {
 }
 
-BigInteger::BigInteger(const BigInteger &obj) : repres(obj.repres)
-{
-}
-
-BigInteger::BigInteger(BigInteger &&obj) noexcept : repres(std::move(obj.repres))
-{
-}
-
-template <typename T>
+template <typename T, typename>
 BigInteger::BigInteger(const T &obj) : repres()
 {
     if (obj < 0)
@@ -276,10 +236,10 @@ BigInteger::BigInteger(const T &obj) : repres()
     }
 }
 
-template <typename T>
+template <typename T, typename>
 BigInteger::BigInteger(T &&obj) : repres()
 {
-    T temp(obj);
+    typename std::decay<T>::type temp(obj);
     while (temp)
     {
         repres.push_back(temp % RADIX);
@@ -287,11 +247,11 @@ BigInteger::BigInteger(T &&obj) : repres()
     }
 }
 
-BigInteger::~BigInteger()
+inline BigInteger::~BigInteger()
 {
 }
 
-BigInteger &BigInteger::operator=(const BigInteger &obj)
+inline BigInteger &BigInteger::operator=(const BigInteger &obj)
 {
     if (this != &obj)
     {
@@ -301,14 +261,24 @@ BigInteger &BigInteger::operator=(const BigInteger &obj)
     return *this;
 }
 
-BigInteger &BigInteger::operator=(BigInteger &&obj)
+inline BigInteger &BigInteger::operator=(BigInteger &&obj)
 {
     repres = std::move(obj.repres);
 
     return *this;
 }
 
-bool BigInteger::operator<(const BigInteger &obj) const noexcept
+inline std::size_t BigInteger::size() const noexcept
+{
+    return repres.size();
+}
+
+inline bool BigInteger::test_bit(std::size_t idx) const noexcept
+{
+    return (get(idx / BITS) >> (idx % BITS)) & 1u;
+}
+
+inline bool BigInteger::operator<(const BigInteger &obj) const noexcept
 {
     if (repres.size() > obj.repres.size())
     {
@@ -325,7 +295,7 @@ bool BigInteger::operator<(const BigInteger &obj) const noexcept
     }
 }
 
-bool BigInteger::operator<=(const BigInteger &obj) const noexcept
+inline bool BigInteger::operator<=(const BigInteger &obj) const noexcept
 {
     if (repres.size() > obj.repres.size())
     {
@@ -342,12 +312,12 @@ bool BigInteger::operator<=(const BigInteger &obj) const noexcept
     }
 }
 
-bool BigInteger::operator==(const BigInteger &obj) const noexcept
+inline bool BigInteger::operator==(const BigInteger &obj) const noexcept
 {
     return this->repres == obj.repres;
 }
 
-bool BigInteger::operator>=(const BigInteger &obj) const noexcept
+inline bool BigInteger::operator>=(const BigInteger &obj) const noexcept
 {
     if (repres.size() > obj.repres.size())
     {
@@ -364,7 +334,7 @@ bool BigInteger::operator>=(const BigInteger &obj) const noexcept
     }
 }
 
-bool BigInteger::operator>(const BigInteger &obj) const noexcept
+inline bool BigInteger::operator>(const BigInteger &obj) const noexcept
 {
     if (repres.size() > obj.repres.size())
     {
@@ -381,395 +351,15 @@ bool BigInteger::operator>(const BigInteger &obj) const noexcept
     }
 }
 
-BigInteger &BigInteger::operator++()
-{
-    *this += Integer(1u);
-
-    return *this;
-}
-
-BigInteger &BigInteger::operator--()
-{
-    *this -= Integer(1u);
-
-    return *this;
-}
-
-BigInteger &BigInteger::operator+=(const BigInteger &obj)
-{
-    if (obj.repres.empty())
-    {
-        return *this;
-    }
-    else if (obj.repres.size() == 1u)
-    {
-        *this += obj.repres.front();
-        return *this;
-    }
-    auto it(repres.begin()), end(repres.end());
-    auto op_it(obj.repres.cbegin()), op_end(obj.repres.cend());
-    register Integer carry(0u);
-    for (; it != end; ++it)
-    {
-        if (op_it != op_end)
-        {
-            *it += *op_it + carry;
-            ++op_it;
-        }
-        else if (carry)
-        {
-            *it += carry;
-        }
-        else
-        {
-            break;
-        }
-        if (*it >= RADIX)
-        {
-            carry = 1u;
-            *it %= RADIX;
-        }
-        else
-        {
-            carry = 0u;
-        }
-    }
-    for (; op_it != op_end; ++op_it)
-    {
-        repres.push_back(*op_it + carry);
-        if (repres.back() >= RADIX)
-        {
-            carry = 1u;
-            repres.back() %= RADIX;
-        }
-        else
-        {
-            carry = 0u;
-        }
-    }
-    if (carry)
-    {
-        repres.push_back(1u);
-    }
-
-    return *this;
-}
-
-BigInteger &BigInteger::operator-=(const BigInteger &obj)
-{
-    if (obj.repres.empty())
-    {
-        return *this;
-    }
-    else if (obj.repres.size() == 1u)
-    {
-        *this -= obj.repres.front();
-        return *this;
-    }
-    else if (repres.size() < obj.repres.size())
-    {
-        throw std::range_error("Unsigned subtraction yielding a negative value");
-    }
-
-    auto it(repres.begin()), end(repres.end());
-    auto op_it(obj.repres.cbegin()), op_end(obj.repres.cend());
-    auto all_zero(end);
-    register Integer carry(0u);
-    for (; it != end; ++it)
-    {
-        if (op_it != op_end)
-        {
-            *it -= *op_it + carry;
-            ++op_it;
-        }
-        else if (carry)
-        {
-            *it -= carry;
-        }
-        else
-        {
-            all_zero = end;
-            break;
-        }
-        if (*it >= RADIX)
-        {
-            carry = 1u;
-            *it += RADIX;
-        }
-        else
-        {
-            carry = 0;
-        }
-        if (*it)
-        {
-            all_zero = end;
-        }
-        else if (all_zero == end)
-        {
-            all_zero = it;
-        }
-    }
-    if (carry)
-    {
-        throw std::range_error("Unsigned subtraction yielding a negative value");
-    }
-    if (all_zero != end)
-    {
-        repres.resize(all_zero - repres.begin());
-    }
-
-    return *this;
-}
-
-BigInteger &BigInteger::operator*=(const BigInteger &obj)
-{
-    *this = *this * obj;
-    return *this;
-}
-
-BigInteger &BigInteger::operator/=(const BigInteger &obj)
-{
-    if (obj.repres.empty())
-    {
-        throw std::overflow_error("Division by zero");
-    }
-    if (repres.size() < obj.repres.size() || (repres.size() == obj.repres.size() && repres.back() < obj.repres.back()))
-    {
-        this->repres.clear();
-        return *this;
-    }
-    if (obj.repres.size() == 1u)
-    {
-        *this /= obj.repres.front();
-        return *this;
-    }
-
-    BigInteger v(obj);
-    if (v.repres.back() < HALF_OF_RADIX)
-    {
-        Integer norm(RADIX / (v.repres.back() + 1u));
-        *this *= norm;
-        v *= norm;
-    }
-
-    BigInteger q, remainder, sub;
-    q.repres.resize(repres.size() - obj.repres.size() + 1u);
-    remainder.repres.resize(v.repres.size() - 1u);
-    std::copy(repres.crbegin(), repres.crbegin() + remainder.repres.size(), remainder.repres.rbegin());
-
-    register const Integer v_n__1(v.repres.back()), v_n__2(*(v.repres.crbegin() + 1u));
-    register const std::size_t n(v.repres.size());
-    auto i_it(repres.crbegin() + remainder.repres.size());
-    auto zero_it(q.repres.crbegin());
-    bool is_find_non_zero = false;
-    const BigInteger radix(RADIX);
-    for (auto j_it(q.repres.rbegin()), j_end(q.repres.rend()); j_it != j_end; ++i_it, ++j_it)
-    {
-        remainder *= radix;
-        remainder += *i_it;
-
-        register const Integer u_n(remainder.get(n)), u_n__1(remainder.get(n - 1u)), u_n__2(remainder.get(n - 2u));
-        Integer q_approxim((u_n * RADIX + u_n__1) / v_n__1), r_approxim((u_n * RADIX + u_n__1) % v_n__1);
-
-        while ((r_approxim < RADIX) && ((q_approxim == RADIX) || (q_approxim * v_n__2 > RADIX * r_approxim + u_n__2)))
-        {
-            --q_approxim;
-            r_approxim += v_n__1;
-        }
-        sub = v * q_approxim;
-        if (remainder < v * q_approxim)
-        {
-            --q_approxim;
-            sub -= v;
-        }
-        *j_it = q_approxim;
-        remainder -= sub;
-
-        if (*j_it)
-        {
-            is_find_non_zero = true;
-        }
-        else if (!is_find_non_zero)
-        {
-            ++zero_it;
-        }
-    }
-    if (zero_it != q.repres.crbegin())
-    {
-        q.repres.resize(q.repres.crend() - zero_it);
-    }
-
-    *this = std::move(q);
-
-    return *this;
-}
-
-BigInteger &power_eq(BigInteger &base, const BigInteger &exp)
-{
-    const BigInteger one(1u);
-    if (base.repres.empty())
-    {
-        if (exp.repres.empty())
-        {
-            throw std::range_error("Division by zero");
-        }
-        else
-        {
-            return base;
-        }
-    }
-    else if (base == one)
-    {
-        return base;
-    }
-    if (exp.repres.empty())
-    {
-        base = one;
-        return base;
-    }
-    else if (exp == one)
-    {
-        return base;
-    }
-
-    BigInteger increm(1u), residue(exp);
-    do
-    {
-        if (residue.repres.back() & 1u)
-        {
-            increm *= base;
-            --residue;
-        }
-        else
-        {
-            base *= base;
-            residue /= 2u;
-        }
-    } while (residue > one);
-    base *= increm;
-
-    return base;
-}
-
-BigInteger BigInteger::operator+(const BigInteger &obj) const
-{
-    BigInteger res(*this);
-    res += obj;
-
-    return res;
-}
-
-BigInteger BigInteger::operator-(const BigInteger &obj) const
-{
-    BigInteger res(*this);
-    res -= obj;
-
-    return res;
-}
-
-BigInteger BigInteger::operator*(const BigInteger &obj) const
-{
-    if (repres.empty() || obj.repres.empty())
-    {
-        return BigInteger();
-    }
-    else if (obj.repres.size() == 1u)
-    {
-        return *this * obj.repres.front();
-    }
-
-    BigInteger res;
-    res.repres.resize(repres.size() + obj.repres.size());
-
-    auto j_it(obj.repres.cbegin()), j_end(obj.repres.cend()), i_it(repres.cbegin()), i_begin(repres.cbegin()), i_end(repres.cend());
-    Integer carry(0u);
-    for (auto res_it(res.repres.begin()), local_res_it(res.repres.begin()); j_it != j_end; ++j_it, ++res_it)
-    {
-        if (!*j_it)
-        {
-            continue;
-        }
-        for (i_it = i_begin, local_res_it = res_it; i_it != i_end; ++i_it, ++local_res_it)
-        {
-            *local_res_it += *j_it * *i_it + carry;
-            carry = *local_res_it / RADIX;
-            *local_res_it %= RADIX;
-        }
-        if (carry)
-        {
-            *local_res_it += carry;
-            carry = 0u;
-        }
-    }
-    if (!res.repres.back())
-    {
-        res.repres.pop_back();
-    }
-
-    return res;
-}
-
-BigInteger BigInteger::operator/(const BigInteger &obj) const
+// The limbs are computed by the compiler; the BigInteger wrapping them is
+// built once, on first use of each distinct literal.
+template <char... Chars>
+const BigInteger &operator"" _bi()
 {
-    BigInteger res(*this);
-    res /= obj;
-
-    return res;
-}
-
-BigInteger power(const BigInteger &base, const BigInteger &exp)
-{
-    BigInteger res(base);
-    power_eq(res, exp);
-
-    return res;
-}
-
-std::ostream &operator<<(std::ostream &stream, const BigInteger &obj)
-{
-    if (obj.repres.empty())
-    {
-        stream << "0";
-
-        return stream;
-    }
-
-    stream << obj.repres.back();
-    for (auto it(obj.repres.crbegin() + 1u), end(obj.repres.crend()); it != end; ++it)
-    {
-        stream << std::setfill('0') << std::setw(BigInteger::DIGITS) << *it;
-    }
-
-    return stream;
-}
-
-std::istream &operator>>(std::istream &stream, BigInteger &obj)
-{
-    obj.repres.resize(1u);
-    obj.repres.back() = 0u;
-
-    std::string buffer;
-    stream >> buffer;
-
-    register BigInteger::Integer digit = 1u;
-    for (auto it(buffer.crbegin()), end(buffer.crend()); it != end; ++it, digit *= BigInteger::TEN)
-    {
-        if (digit >= obj.RADIX)
-        {
-            obj.repres.push_back(0u);
-            digit = 1u;
-        }
-        obj.repres.back() += (*it - '0') * digit;
-    }
-
-    auto it(obj.repres.crbegin()), end(obj.repres.crend());
-    while (it != end && !*it)
-    {
-        ++it;
-    }
-    obj.repres.resize(end - it);
+    static constexpr const BigInteger::Literal<sizeof...(Chars) / 8u + 1u> literal(BigInteger::parse_literal<sizeof...(Chars) / 8u + 1u, Chars...>());
+    static const BigInteger value(BigInteger::from_limbs(literal.limbs, literal.size));
 
-    return stream;
+    return value;
 }
 
 #endif
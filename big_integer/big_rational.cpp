@@ -0,0 +1,320 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "./big_rational.hpp"
+
+std::atomic<std::size_t> &BigRational::threshold()
+{
+    static std::atomic<std::size_t> limbs(16u);
+    return limbs;
+}
+
+BigRational BigRational::normalized() const
+{
+    BigRational res(*this);
+    res.reduce();
+
+    return res;
+}
+
+void BigRational::reduce_if_large()
+{
+    if (is_zero())
+    {
+        negative = false;
+    }
+    if (is_large())
+    {
+        reduce();
+    }
+}
+
+BigRational &BigRational::add(const BigRational &obj, bool subtract)
+{
+    const bool obj_negative(obj.negative != subtract);
+    BigInteger rhs;
+    if (den == obj.den)
+    {
+        rhs = obj.num;
+    }
+    else
+    {
+        rhs = obj.num * den;
+        num *= obj.den;
+        den *= obj.den;
+    }
+
+    if (negative == obj_negative)
+    {
+        num += rhs;
+    }
+    else if (num >= rhs)
+    {
+        num -= rhs;
+    }
+    else
+    {
+        rhs -= num;
+        num = std::move(rhs);
+        negative = obj_negative;
+    }
+    reduced = false;
+    reduce_if_large();
+
+    return *this;
+}
+
+BigRational &BigRational::multiply(const BigInteger &obj_num, const BigInteger &obj_den, bool obj_negative, bool obj_reduced)
+{
+    negative = negative != obj_negative;
+    if (num.size() + den.size() + obj_num.size() + obj_den.size() > threshold().load(std::memory_order_relaxed))
+    {
+        // Cross-cancellation keeps both products small; for reduced operands
+        // the result is reduced too.
+        const BigInteger g1(gcd(num, obj_den)), g2(gcd(obj_num, den));
+        num /= g1;
+        den /= g2;
+        num *= obj_num / g2;
+        den *= obj_den / g1;
+        reduced = reduced && obj_reduced;
+    }
+    else
+    {
+        num *= obj_num;
+        den *= obj_den;
+        reduced = false;
+    }
+    reduce_if_large();
+
+    return *this;
+}
+
+int BigRational::compare(const BigRational &obj) const
+{
+    if (negative != obj.negative)
+    {
+        return negative ? -1 : 1;
+    }
+
+    // Cross-multiplication orders unreduced fractions as well.
+    int res(0);
+    if (den == obj.den)
+    {
+        res = num < obj.num ? -1 : (obj.num < num ? 1 : 0);
+    }
+    else
+    {
+        const BigInteger lhs(num * obj.den), rhs(obj.num * den);
+        res = lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+    }
+
+    return negative ? -res : res;
+}
+
+BigRational::BigRational() : num(), den(1u), negative(false), reduced(true)
+{
+}
+
+BigRational::BigRational(const BigInteger &obj) : num(obj), den(1u), negative(false), reduced(true)
+{
+}
+
+BigRational::BigRational(const BigInteger &numerator, const BigInteger &denominator, bool is_negative) :
+    num(numerator), den(denominator), negative(is_negative), reduced(false)
+{
+    if (!den.size())
+    {
+        throw std::overflow_error("Division by zero");
+    }
+    reduce_if_large();
+}
+
+std::size_t BigRational::reduce_threshold() noexcept
+{
+    return threshold().load(std::memory_order_relaxed);
+}
+
+void BigRational::set_reduce_threshold(std::size_t limbs) noexcept
+{
+    threshold().store(limbs, std::memory_order_relaxed);
+}
+
+void BigRational::reduce()
+{
+    if (reduced)
+    {
+        return;
+    }
+    if (is_zero())
+    {
+        den = BigInteger(1u);
+    }
+    else
+    {
+        const BigInteger g(gcd(num, den));
+        if (g.size() > 1u || !(g == BigInteger(1u)))
+        {
+            num /= g;
+            den /= g;
+        }
+    }
+    reduced = true;
+}
+
+BigInteger BigRational::numerator() const
+{
+    return reduced ? num : normalized().num;
+}
+
+BigInteger BigRational::denominator() const
+{
+    return reduced ? den : normalized().den;
+}
+
+bool BigRational::operator<(const BigRational &obj) const
+{
+    return compare(obj) < 0;
+}
+
+bool BigRational::operator<=(const BigRational &obj) const
+{
+    return compare(obj) <= 0;
+}
+
+bool BigRational::operator==(const BigRational &obj) const
+{
+    return compare(obj) == 0;
+}
+
+bool BigRational::operator>=(const BigRational &obj) const
+{
+    return compare(obj) >= 0;
+}
+
+bool BigRational::operator>(const BigRational &obj) const
+{
+    return compare(obj) > 0;
+}
+
+BigRational BigRational::operator-() const
+{
+    BigRational res(*this);
+    if (!res.is_zero())
+    {
+        res.negative = !res.negative;
+    }
+
+    return res;
+}
+
+BigRational &BigRational::operator+=(const BigRational &obj)
+{
+    return add(obj, false);
+}
+
+BigRational &BigRational::operator-=(const BigRational &obj)
+{
+    return add(obj, true);
+}
+
+BigRational &BigRational::operator*=(const BigRational &obj)
+{
+    if (this == &obj)
+    {
+        const BigRational copy(obj);
+        return multiply(copy.num, copy.den, copy.negative, copy.reduced);
+    }
+
+    return multiply(obj.num, obj.den, obj.negative, obj.reduced);
+}
+
+BigRational &BigRational::operator/=(const BigRational &obj)
+{
+    if (obj.is_zero())
+    {
+        throw std::overflow_error("Division by zero");
+    }
+
+    if (this == &obj)
+    {
+        *this = BigRational(BigInteger(1u));
+        return *this;
+    }
+
+    return multiply(obj.den, obj.num, obj.negative, obj.reduced);
+}
+
+BigRational BigRational::operator+(const BigRational &obj) const
+{
+    BigRational res(*this);
+    res += obj;
+
+    return res;
+}
+
+BigRational BigRational::operator-(const BigRational &obj) const
+{
+    BigRational res(*this);
+    res -= obj;
+
+    return res;
+}
+
+BigRational BigRational::operator*(const BigRational &obj) const
+{
+    BigRational res(*this);
+    res *= obj;
+
+    return res;
+}
+
+BigRational BigRational::operator/(const BigRational &obj) const
+{
+    BigRational res(*this);
+    res /= obj;
+
+    return res;
+}
+
+std::ostream &operator<<(std::ostream &stream, const BigRational &obj)
+{
+    if (!obj.reduced)
+    {
+        return stream << obj.normalized();
+    }
+
+    if (obj.negative)
+    {
+        stream << '-';
+    }
+    stream << obj.num;
+    if (obj.den.size() > 1u || !(obj.den == BigInteger(1u)))
+    {
+        stream << '/' << obj.den;
+    }
+
+    return stream;
+}
+
+std::istream &operator>>(std::istream &stream, BigRational &obj)
+{
+    std::string buffer;
+    stream >> buffer;
+
+    const bool is_negative(!buffer.empty() && buffer.front() == '-');
+    const std::string::size_type slash(buffer.find('/'));
+    std::istringstream num_stream(buffer.substr(is_negative, slash - is_negative));
+    BigInteger numerator, denominator(1u);
+    num_stream >> numerator;
+    if (slash != std::string::npos)
+    {
+        std::istringstream den_stream(buffer.substr(slash + 1u));
+        den_stream >> denominator;
+    }
+
+    obj = BigRational(numerator, denominator, is_negative);
+
+    return stream;
+}
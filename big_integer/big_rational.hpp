@@ -0,0 +1,90 @@
+#ifndef _BIG_RATIONAL_H_
+#define _BIG_RATIONAL_H_
+
+#include <atomic>
+#include <iostream>
+
+#include "./big_integer.hpp"
+
+// Signed fraction of two BigIntegers. Reduction by the gcd is lazy: it runs
+// only once numerator and denominator together exceed reduce_threshold()
+// limbs, or on reduce(). A threshold of zero reduces after every operation.
+// The const members never reduce in place; numerator(), denominator() and
+// output reduce a copy. So like BigInteger, a BigRational may be read from
+// several threads at once, but not written while it is read.
+class BigRational
+{
+private:
+    BigInteger num;
+    BigInteger den;
+    bool negative;
+    bool reduced;
+
+    static std::atomic<std::size_t> &threshold();
+
+    bool is_zero() const noexcept;
+    bool is_large() const noexcept;
+    BigRational normalized() const;
+    void reduce_if_large();
+    BigRational &add(const BigRational &, bool);
+    BigRational &multiply(const BigInteger &, const BigInteger &, bool, bool);
+    int compare(const BigRational &) const;
+
+public:
+    BigRational();
+    BigRational(const BigInteger &);
+    BigRational(const BigInteger &, const BigInteger &, bool = false);
+    BigRational(const BigRational &) = default;
+    BigRational(BigRational &&) noexcept = default;
+
+    ~BigRational() = default;
+
+    BigRational &operator=(const BigRational &) = default;
+    BigRational &operator=(BigRational &&) noexcept = default;
+
+    static std::size_t reduce_threshold() noexcept;
+    static void set_reduce_threshold(std::size_t) noexcept;
+
+    void reduce();
+    BigInteger numerator() const;
+    BigInteger denominator() const;
+    bool is_negative() const noexcept;
+
+    bool operator<(const BigRational &) const;
+    bool operator<=(const BigRational &) const;
+    bool operator==(const BigRational &) const;
+    bool operator>=(const BigRational &) const;
+    bool operator>(const BigRational &) const;
+
+    BigRational operator-() const;
+
+    BigRational &operator+=(const BigRational &);
+    BigRational &operator-=(const BigRational &);
+    BigRational &operator*=(const BigRational &);
+    BigRational &operator/=(const BigRational &);
+
+    BigRational operator+(const BigRational &) const;
+    BigRational operator-(const BigRational &) const;
+    BigRational operator*(const BigRational &) const;
+    BigRational operator/(const BigRational &) const;
+
+    friend std::ostream &operator<<(std::ostream &, const BigRational &);
+    friend std::istream &operator>>(std::istream &, BigRational &);
+};
+
+inline bool BigRational::is_zero() const noexcept
+{
+    return !num.size();
+}
+
+inline bool BigRational::is_large() const noexcept
+{
+    return num.size() + den.size() > threshold().load(std::memory_order_relaxed);
+}
+
+inline bool BigRational::is_negative() const noexcept
+{
+    return negative;
+}
+
+#endif
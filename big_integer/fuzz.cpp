@@ -0,0 +1,673 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "big_float.hpp"
+#include "big_integer.hpp"
+#include "big_rational.hpp"
+#include "prime.hpp"
+#include "random_big_integer.hpp"
+#include "shared_big_integer.hpp"
+
+// Differential fuzzer: every BigInteger operation is checked against a slow
+// schoolbook implementation on decimal strings (sqrt by the inequality that
+// defines the floor root, gcd and power_eq on truncated operands),
+// BigRational arithmetic and comparison against fractions reduced by the
+// same helpers, and short decimals have to read back through BigFloat
+// unchanged. Fixed checks run first: _bi literals in every base,
+// SharedBigInteger copy-on-write, and primality against a sieve and known
+// pseudoprimes.
+//
+// Usage: fuzz [iterations] [seed] [max_limbs]
+
+namespace reference
+{
+    int compare(const std::string &lhs, const std::string &rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return lhs.size() < rhs.size() ? -1 : 1;
+        }
+
+        return lhs.compare(rhs) < 0 ? -1 : (lhs.compare(rhs) > 0 ? 1 : 0);
+    }
+
+    std::string trim(const std::string &obj)
+    {
+        const std::string::size_type first(obj.find_first_not_of('0'));
+
+        return first == std::string::npos ? "0" : obj.substr(first);
+    }
+
+    std::string add(const std::string &lhs, const std::string &rhs)
+    {
+        std::string res;
+        int carry(0);
+        for (std::size_t i = 0u; i < std::max(lhs.size(), rhs.size()) || carry; ++i)
+        {
+            const int sum(carry + (i < lhs.size() ? lhs[lhs.size() - 1u - i] - '0' : 0)
+                + (i < rhs.size() ? rhs[rhs.size() - 1u - i] - '0' : 0));
+            res.push_back(char('0' + sum % 10));
+            carry = sum / 10;
+        }
+        std::reverse(res.begin(), res.end());
+
+        return trim(res);
+    }
+
+    std::string subtract(const std::string &lhs, const std::string &rhs)
+    {
+        std::string res;
+        int borrow(0);
+        for (std::size_t i = 0u; i < lhs.size(); ++i)
+        {
+            int diff(lhs[lhs.size() - 1u - i] - '0' - borrow - (i < rhs.size() ? rhs[rhs.size() - 1u - i] - '0' : 0));
+            borrow = diff < 0;
+            res.push_back(char('0' + diff + 10 * borrow));
+        }
+        std::reverse(res.begin(), res.end());
+
+        return trim(res);
+    }
+
+    std::string multiply(const std::string &lhs, const std::string &rhs)
+    {
+        std::vector<int> digits(lhs.size() + rhs.size());
+        for (std::size_t i = 0u; i < lhs.size(); ++i)
+        {
+            for (std::size_t j = 0u; j < rhs.size(); ++j)
+            {
+                digits[i + j + 1u] += (lhs[i] - '0') * (rhs[j] - '0');
+            }
+        }
+        for (std::size_t k = digits.size() - 1u; k > 0u; --k)
+        {
+            digits[k - 1u] += digits[k] / 10;
+            digits[k] %= 10;
+        }
+
+        std::string res;
+        for (const int digit : digits)
+        {
+            res.push_back(char('0' + digit));
+        }
+
+        return trim(res);
+    }
+
+    // Quotient and remainder by long division, one decimal digit at a time.
+    std::string divide(const std::string &lhs, const std::string &rhs, std::string &remainder)
+    {
+        std::string res;
+        remainder = "0";
+        for (const char digit : lhs)
+        {
+            remainder = trim(remainder + digit);
+            char q('0');
+            while (compare(remainder, rhs) >= 0)
+            {
+                remainder = subtract(remainder, rhs);
+                ++q;
+            }
+            res.push_back(q);
+        }
+
+        return trim(res);
+    }
+
+    std::string power_of_two(std::size_t count)
+    {
+        std::string res("1");
+        while (count--)
+        {
+            res = add(res, res);
+        }
+
+        return res;
+    }
+
+    std::string to_binary(std::string obj)
+    {
+        std::string res, remainder;
+        while (obj != "0")
+        {
+            obj = divide(obj, "2", remainder);
+            res.push_back(remainder[0]);
+        }
+
+        return res;
+    }
+
+    std::string from_binary(const std::string &obj)
+    {
+        std::string res("0");
+        for (auto it(obj.crbegin()), end(obj.crend()); it != end; ++it)
+        {
+            res = add(res, res);
+            if (*it == '1')
+            {
+                res = add(res, "1");
+            }
+        }
+
+        return res;
+    }
+
+    std::string gcd(std::string lhs, std::string rhs)
+    {
+        std::string remainder;
+        while (rhs != "0")
+        {
+            divide(lhs, rhs, remainder);
+            lhs = rhs;
+            rhs = remainder;
+        }
+
+        return lhs;
+    }
+
+    // lhs + rhs for signed magnitudes; negative receives the sign of the sum.
+    std::string add(const bool lhs_negative, const std::string &lhs, const bool rhs_negative, const std::string &rhs,
+        bool &negative)
+    {
+        if (lhs_negative == rhs_negative)
+        {
+            negative = lhs_negative;
+            return add(lhs, rhs);
+        }
+
+        const bool less(compare(lhs, rhs) < 0);
+        negative = less ? rhs_negative : lhs_negative;
+        return less ? subtract(rhs, lhs) : subtract(lhs, rhs);
+    }
+
+    // num / den in lowest terms, printed like a BigRational.
+    std::string fraction(const bool negative, const std::string &num, const std::string &den)
+    {
+        std::string remainder;
+        const std::string g(gcd(num, den)), n(divide(num, g, remainder)), d(divide(den, g, remainder));
+
+        return (negative && n != "0" ? "-" : "") + n + (d == "1" ? "" : "/" + d);
+    }
+
+    // One plus the digits [first, first + count) of obj, so never zero.
+    std::string piece(const std::string &obj, const std::size_t first, const std::size_t count)
+    {
+        return add(trim(obj.substr(std::min(first, obj.size()), count)), "1");
+    }
+
+    std::string bitwise(const std::string &lhs, const std::string &rhs, char op)
+    {
+        std::string a(to_binary(lhs)), b(to_binary(rhs));
+        a.resize(std::max(a.size(), b.size()), '0');
+        b.resize(a.size(), '0');
+        for (std::size_t i = 0u; i < a.size(); ++i)
+        {
+            const bool x(a[i] == '1'), y(b[i] == '1');
+            a[i] = (op == '&' ? x && y : (op == '|' ? x || y : x != y)) ? '1' : '0';
+        }
+
+        return from_binary(a);
+    }
+}
+
+template <typename T>
+std::string text(const T &obj)
+{
+    std::ostringstream stream;
+    stream << obj;
+
+    return stream.str();
+}
+
+BigInteger operand(std::mt19937 &choice, RandomBigInteger &generator, std::size_t max_limbs, const BigInteger &other)
+{
+    const std::size_t limbs(1u + std::size_t(choice()) % max_limbs);
+    switch (choice() % 7)
+    {
+        case 0:
+            return generator.adversarial(limbs);
+        case 1:
+            return generator.sparse(32u * limbs, 1u + std::size_t(choice()) % 8u);
+        case 2:
+            return other.size() ? generator.below(other) : BigInteger();
+        case 3:
+            return generator.bits(std::size_t(choice()) % 64u);
+        case 4:
+            return generator.exact_bits(32u * limbs - std::size_t(choice()) % 32u);
+        default:
+            return generator.limbs(limbs);
+    }
+}
+
+bool check(const bool passed, const std::string &what)
+{
+    if (!passed)
+    {
+        std::cout << what << " failed\n";
+    }
+
+    return passed;
+}
+
+// Every base and digit separators; each distinct literal is one object.
+bool check_literals()
+{
+    const std::vector<std::pair<std::string, std::string>> cases{
+        {text(0_bi), "0"},
+        {text(07_bi), "7"},
+        {text(123456789012345678901234567890_bi), "123456789012345678901234567890"},
+        {text(1'000'000'000'000'000'000'000_bi), "1000000000000000000000"},
+        {text(0xdeadBEEF_bi), "3735928559"},
+        {text(0xFFFF'FFFF'FFFF'FFFF'FFFF_bi), "1208925819614629174706175"},
+        {text(0b1'0000'0000'0000'0000'0000'0000'0000'0000_bi), "4294967296"},
+        {text(0B101_bi), "5"},
+        {text(0777'7777'7777'7777'7777'7777_bi), "590295810358705651711"}};
+    bool passed(true);
+    for (const auto &item : cases)
+    {
+        passed = check(item.first == item.second, "literal " + item.second) && passed;
+    }
+
+    return check(&42_bi == &42_bi && &42_bi != &0x2a_bi, "literal identity") && passed;
+}
+
+// Modifying a copy clones the shared value and leaves the original alone;
+// a handle that owns its value alone modifies it where it is.
+bool check_shared()
+{
+    const BigInteger value((BigInteger(1u) << 200u) + BigInteger(12345u)), other(BigInteger(1u) << 70u);
+    const SharedBigInteger original(value);
+    bool passed(true);
+    for (const char op : std::string("+-adms"))
+    {
+        SharedBigInteger copy(original);
+        passed = check(!original.unique() && &copy.get() == &original.get(), std::string("shared copy for '") + op + "'") && passed;
+
+        BigInteger expected(value);
+        const BigInteger *address(nullptr);
+        for (int round = 0; round < 2; ++round)
+        {
+            switch (op)
+            {
+                case '+':
+                    ++copy;
+                    ++expected;
+                    break;
+                case '-':
+                    --copy;
+                    --expected;
+                    break;
+                case 'a':
+                    copy += other;
+                    expected += other;
+                    break;
+                case 'd':
+                    copy /= other;
+                    expected /= other;
+                    break;
+                case 'm':
+                    copy *= other;
+                    expected *= other;
+                    break;
+                case 's':
+                    copy -= other;
+                    expected -= other;
+                    break;
+            }
+            if (address)
+            {
+                passed = check(&copy.get() == address, std::string("in place '") + op + "'") && passed;
+            }
+            address = &copy.get();
+        }
+        passed = check(copy.get() == expected && copy.unique(), std::string("copy after '") + op + "'") && passed;
+        passed = check(original.get() == value && original.unique(), std::string("original after '") + op + "'") && passed;
+    }
+
+    return passed;
+}
+
+// Primality of first + i for i < count, by a segmented sieve.
+std::vector<bool> sieve(const unsigned long long first, const std::size_t count)
+{
+    std::vector<bool> res(count, true);
+    for (unsigned long long n = first; n < std::min(first + count, 2ull); ++n)
+    {
+        res[n - first] = false;
+    }
+    for (unsigned long long p = 2u; p * p < first + count; ++p)
+    {
+        for (unsigned long long q = std::max(p * p, (first + p - 1u) / p * p); q < first + count; q += p)
+        {
+            res[q - first] = false;
+        }
+    }
+
+    return res;
+}
+
+BigInteger parse(const std::string &obj)
+{
+    BigInteger res;
+    std::istringstream stream(obj);
+    stream >> res;
+
+    return res;
+}
+
+// is_prime and next_prime against a sieve below 2^16, where trial division
+// decides, around 2048^2, where BPSW takes over, and around 2^32, where the
+// values grow a limb.
+// Strong base-2 pseudoprimes get past Miller-Rabin and must fail the Lucas
+// test; the strong Lucas pseudoprimes have no factor below the trial
+// division bound and must fail Miller-Rabin. The batch test runs on several
+// threads and must agree.
+bool check_primes()
+{
+    bool passed(true);
+    std::vector<BigInteger> batch;
+    std::vector<bool> expected;
+    const unsigned long long windows[][2] = {{0u, 1u << 16}, {(1u << 22) - (1u << 13), 1u << 14}, {(1ull << 32) - (1u << 14), 1u << 15}};
+    for (const auto &window : windows)
+    {
+        const std::vector<bool> primes(sieve(window[0], std::size_t(window[1])));
+        std::size_t next(primes.size());
+        for (std::size_t i = primes.size(); i-- > 0u;)
+        {
+            const BigInteger n(window[0] + i);
+            passed = check(is_prime(n) == primes[i], "is_prime(" + text(n) + ")") && passed;
+            if (next < primes.size())
+            {
+                passed = check(next_prime(n) == BigInteger(window[0] + next), "next_prime(" + text(n) + ")") && passed;
+            }
+            next = primes[i] ? i : next;
+            batch.push_back(n);
+            expected.push_back(primes[i]);
+        }
+    }
+
+    static const char *const composites[] = {
+        "2047", "3277", "4033", "4681", "8321", "15841", "29341", "42799", "49141", "52633", "65281", "74665", "80581",
+        "85489", "88357", "90751", "3215031751", "2152302898747", "3474749660383", "341550071728321",
+        "3825123056546413051", "318665857834031151167461", "3317044064679887385961981",
+        "561", "1105", "1729", "41041", "825265", "321197185", "5394826801", "232250619601", "9746347772161",
+        "5459", "5777", "10877", "16109", "18971", "22499", "24569", "25199", "40309", "58519",
+        "5450201", "7199399", "7453619", "8518127", "147573952589676412927"};
+    for (const char *const composite : composites)
+    {
+        batch.push_back(parse(composite));
+        expected.push_back(false);
+        passed = check(!is_prime(batch.back()), std::string("is_prime(") + composite + ")") && passed;
+    }
+    for (const unsigned exponent : {61u, 89u, 107u, 127u})
+    {
+        batch.push_back((BigInteger(1u) << exponent) - BigInteger(1u));
+        expected.push_back(true);
+        passed = check(is_prime(batch.back()), "is_prime(2^" + std::to_string(exponent) + " - 1)") && passed;
+    }
+
+    passed = check(next_prime(BigInteger(1u) << 64u) == (BigInteger(1u) << 64u) + BigInteger(13u), "next_prime(2^64)") && passed;
+    passed = check(next_prime(BigInteger(1u) << 128u) == (BigInteger(1u) << 128u) + BigInteger(51u), "next_prime(2^128)") && passed;
+    for (const unsigned threads : {2u, 3u, 8u})
+    {
+        passed = check(is_prime(batch, threads) == expected, "is_prime batch on " + std::to_string(threads) + " threads") && passed;
+    }
+
+    return passed;
+}
+
+bool parse(const char *text, unsigned long &value)
+{
+    char *end(nullptr);
+    errno = 0;
+    value = std::strtoul(text, &end, 10);
+    return std::isdigit(static_cast<unsigned char>(*text)) && *end == '\0' && errno == 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iterations(10000u), seed(1u), max_limbs(24u);
+    if (argc > 4 || (argc > 1 && !parse(argv[1], iterations)) || (argc > 2 && !parse(argv[2], seed))
+        || (argc > 3 && (!parse(argv[3], max_limbs) || max_limbs == 0u)))
+    {
+        std::cerr << "Usage: fuzz [iterations] [seed] [max_limbs]\n";
+        return 1;
+    }
+
+    std::mt19937 choice(seed);
+    RandomBigInteger generator(seed);
+    static const char ops[] = "+-*/%<=&|^LRsfqrgpb";
+
+    const BigFloat one(BigInteger(1u)), three(BigInteger(3u));
+    if (text(one / three * three) != "1")
+    {
+        std::cout << "1/3*3 printed as " << text(one / three * three) << "\n";
+        return 1;
+    }
+    BigFloat third(one);
+    third.set_precision(20u) /= three;
+    if (third.precision() != 20u || text(third) != "0." + std::string(20u, '3'))
+    {
+        std::cout << "1/3 at 20 digits printed as " << text(third) << "\n";
+        return 1;
+    }
+    if (!check_literals() || !check_shared() || !check_primes())
+    {
+        return 1;
+    }
+
+    for (unsigned long it = 0u; it < iterations; ++it)
+    {
+        const BigInteger a(operand(choice, generator, max_limbs, BigInteger()));
+        const BigInteger b(operand(choice, generator, max_limbs, a));
+        const std::string x(text(a)), y(text(b));
+        const char op(ops[choice() % (sizeof(ops) - 1u)]);
+        const std::size_t shift(std::size_t(choice()) % 100u);
+
+        std::string expected, actual;
+        try
+        {
+            switch (op)
+            {
+                case '+':
+                    expected = reference::add(x, y);
+                    actual = text(a + b);
+                    break;
+                case '-':
+                    expected = reference::compare(x, y) >= 0 ? reference::subtract(x, y) : "Error";
+                    actual = text(a - b);
+                    break;
+                case '*':
+                    expected = reference::multiply(x, y);
+                    actual = text(a * b);
+                    break;
+                case '/':
+                case '%':
+                {
+                    std::string remainder;
+                    expected = y == "0" ? "Error" : reference::divide(x, y, remainder);
+                    expected = op == '%' && y != "0" ? remainder : expected;
+                    actual = text(op == '/' ? a / b : a % b);
+                    break;
+                }
+                case '<':
+                    expected = std::to_string(reference::compare(x, y));
+                    actual = std::to_string(a < b ? -1 : (a > b ? 1 : 0));
+                    break;
+                case '=':
+                    expected = std::to_string(x == y) + std::to_string(reference::compare(x, y) <= 0);
+                    actual = std::to_string(a == b) + std::to_string(a <= b);
+                    break;
+                case '&':
+                case '|':
+                case '^':
+                    expected = reference::bitwise(x, y, op);
+                    actual = text(op == '&' ? a & b : (op == '|' ? a | b : a ^ b));
+                    break;
+                case 'L':
+                    expected = reference::multiply(x, reference::power_of_two(shift));
+                    actual = text(a << shift);
+                    break;
+                case 'R':
+                {
+                    std::string remainder;
+                    expected = reference::divide(x, reference::power_of_two(shift), remainder);
+                    actual = text(a >> shift);
+                    break;
+                }
+                case 's':
+                {
+                    BigInteger parsed;
+                    std::istringstream stream(x);
+                    stream >> parsed;
+                    expected = x;
+                    actual = text(parsed);
+                    break;
+                }
+                case 'f':
+                {
+                    // Up to 40 digits of x with a point at shift, well inside
+                    // the default precision.
+                    const std::string digits(x.substr(0u, 40u));
+                    const std::size_t point(std::min(shift, digits.size()));
+                    const std::string integer(reference::trim(digits.substr(0u, point)));
+                    std::string fraction(digits.substr(point));
+                    fraction.erase(fraction.find_last_not_of('0') + 1u);
+                    expected = fraction.empty() ? integer : integer + "." + fraction;
+
+                    BigFloat parsed;
+                    std::istringstream stream(integer + "." + digits.substr(point));
+                    stream >> parsed;
+                    actual = text(parsed);
+                    break;
+                }
+                case 'r':
+                {
+                    // The floor square root r is the one with r^2 <= x < (r + 1)^2.
+                    const std::string root(text(sqrt(a))), next(reference::add(root, "1"));
+                    expected = reference::compare(reference::multiply(root, root), x) <= 0
+                        && reference::compare(x, reference::multiply(next, next)) < 0 ? root : "not the floor root";
+                    actual = root;
+                    break;
+                }
+                case 'g':
+                {
+                    // Short operands times a common factor, so that the
+                    // reference Euclid stays cheap and the gcd is large.
+                    const std::string k(reference::piece(x, 30u, 20u));
+                    const std::string lhs(reference::multiply(reference::trim(x.substr(0u, 30u)), k));
+                    const std::string rhs(reference::multiply(reference::trim(y.substr(0u, 30u)), k));
+                    expected = reference::gcd(lhs, rhs);
+                    actual = text(gcd(parse(lhs), parse(rhs)));
+                    break;
+                }
+                case 'p':
+                {
+                    // 0^0 is rejected.
+                    const std::string base(reference::trim(x.substr(0u, 12u)));
+                    expected = base == "0" && shift % 20u == 0u ? "Error" : "1";
+                    for (std::size_t i = 0u; i < shift % 20u && expected != "Error"; ++i)
+                    {
+                        expected = reference::multiply(expected, base);
+                    }
+                    BigInteger res(parse(base));
+                    power_eq(res, BigInteger(shift % 20u));
+                    actual = text(res);
+                    break;
+                }
+                case 'b':
+                {
+                    const std::string binary(reference::to_binary(x));
+                    const std::size_t bit(8u * shift);
+                    expected = std::to_string(binary.size()) + " "
+                        + std::to_string(std::count(binary.begin(), binary.end(), '1')) + " "
+                        + std::to_string(bit < binary.size() && binary[bit] == '1');
+                    actual = std::to_string(a.bit_length()) + " " + std::to_string(a.popcount()) + " "
+                        + std::to_string(a.test_bit(bit));
+                    break;
+                }
+                case 'q':
+                {
+                    // (p * k) / (q * m) and (r * m) / (s * k): unreduced, and
+                    // a product cross-cancels k and m. The threshold decides
+                    // whether reduction is eager, lazy or left to output.
+                    static const std::size_t thresholds[] = {0u, 1u, 4u, 64u};
+                    BigRational::set_reduce_threshold(thresholds[shift % 4u]);
+                    const std::string k(reference::piece(x, 20u, 6u)), m(reference::piece(y, 20u, 6u));
+                    const std::string n1(reference::multiply(reference::trim(x.substr(0u, 9u)), k));
+                    const std::string d1(reference::multiply(reference::piece(y, 0u, 9u), m));
+                    const std::string n2(reference::multiply(reference::trim(y.substr(y.size() / 2u, 9u)), m));
+                    const std::string d2(reference::multiply(reference::piece(x, x.size() / 2u, 9u), k));
+                    const bool negative1(shift & 4u), negative2(shift & 8u);
+                    const BigRational r1(parse(n1), parse(d1), negative1), r2(parse(n2), parse(d2), negative2);
+
+                    const char rational_op("+-*/<="[shift / 16u % 6u]);
+                    bool negative;
+                    switch (rational_op)
+                    {
+                        case '+':
+                        case '-':
+                        {
+                            const bool subtract(rational_op == '-');
+                            const std::string num(reference::add(negative1, reference::multiply(n1, d2),
+                                negative2 != subtract, reference::multiply(n2, d1), negative));
+                            expected = reference::fraction(negative, num, reference::multiply(d1, d2));
+                            actual = text(subtract ? r1 - r2 : r1 + r2);
+                            break;
+                        }
+                        case '*':
+                            expected = reference::fraction(negative1 != negative2, reference::multiply(n1, n2),
+                                reference::multiply(d1, d2));
+                            actual = text(r1 * r2);
+                            break;
+                        case '/':
+                            expected = n2 == "0" ? "Error" : reference::fraction(negative1 != negative2,
+                                reference::multiply(n1, d2), reference::multiply(d1, n2));
+                            actual = text(r1 / r2);
+                            break;
+                        case '<':
+                        {
+                            const std::string difference(reference::add(negative1, reference::multiply(n1, d2),
+                                !negative2, reference::multiply(n2, d1), negative));
+                            expected = std::to_string(difference == "0" ? 0 : (negative ? -1 : 1));
+                            actual = std::to_string(r1 < r2 ? -1 : (r1 > r2 ? 1 : 0));
+                            break;
+                        }
+                        default:
+                        {
+                            const std::string difference(reference::add(negative1, reference::multiply(n1, d2),
+                                !negative2, reference::multiply(n2, d1), negative));
+                            expected = std::to_string(difference == "0") + std::to_string(difference == "0" || negative);
+                            actual = std::to_string(r1 == r2) + std::to_string(r1 <= r2);
+                            break;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        catch (const std::exception &)
+        {
+            actual = "Error";
+        }
+
+        if (expected != actual)
+        {
+            std::cout << "Mismatch at iteration " << it << " for '" << op << "'\n"
+                << "lhs:      " << x << "\nrhs:      " << y << "\nshift:    " << shift
+                << "\nexpected: " << expected << "\nactual:   " << actual << "\n";
+            return 1;
+        }
+    }
+    std::cout << iterations << " iterations passed\n";
+
+    return 0;
+}
@@ -0,0 +1,365 @@
+#ifndef _BIG_INTEGER_INSTRUMENTATION_H_
+#define _BIG_INTEGER_INSTRUMENTATION_H_
+
+#include <cstddef>
+#include <memory>
+
+#ifdef BIG_INTEGER_INSTRUMENTATION
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Opt-in counters for BigInteger, enabled by defining
+// BIG_INTEGER_INSTRUMENTATION for the library and every user of it
+// (make DEFINES=-DBIG_INTEGER_INSTRUMENTATION). Each thread updates
+// only its own counters; a snapshot sums the live threads and those that have
+// already exited. Times are inclusive, so a sqrt also accounts for the
+// divisions it performs.
+namespace big_integer_instrumentation
+{
+    enum Operation
+    {
+        ADD, SUBTRACT, MULTIPLY, DIVIDE, SHIFT, BITWISE, POWER, SQRT, GCD, INPUT, OUTPUT, OPERATIONS
+    };
+
+    enum Tier
+    {
+        TRIVIAL, SINGLE_LIMB, SCHOOLBOOK, TIERS
+    };
+
+    // Bucket 0 holds empty operands, bucket k sizes in [2^(k-1), 2^k) limbs.
+    constexpr const std::size_t BUCKETS = 8u * sizeof(std::size_t) + 1u;
+
+    struct Snapshot
+    {
+        unsigned long long calls[OPERATIONS][TIERS];
+        unsigned long long limbs[OPERATIONS][BUCKETS];
+        unsigned long long nanoseconds[OPERATIONS];
+        unsigned long long allocations;
+        unsigned long long deallocations;
+        unsigned long long allocated_bytes;
+    };
+
+    class Counters
+    {
+    private:
+        typedef std::atomic<unsigned long long> Counter;
+
+        Counter calls[OPERATIONS][TIERS];
+        Counter limbs[OPERATIONS][BUCKETS];
+        Counter nanoseconds[OPERATIONS];
+        Counter allocations;
+        Counter deallocations;
+        Counter allocated_bytes;
+
+        static void increase(Counter &, unsigned long long) noexcept;
+
+    public:
+        Counters();
+        Counters(const Counters &) = delete;
+
+        ~Counters();
+
+        Counters &operator=(const Counters &) = delete;
+
+        void record(Operation, Tier, std::size_t, unsigned long long) noexcept;
+        void record_allocation(std::size_t) noexcept;
+        void record_deallocation() noexcept;
+        void accumulate(Snapshot &) const noexcept;
+        void clear() noexcept;
+    };
+
+    class Scope
+    {
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        Operation operation;
+        Tier tier;
+        std::size_t limbs;
+        clock::time_point start;
+
+    public:
+        Scope(Operation, std::size_t) noexcept;
+        Scope(const Scope &) = delete;
+
+        ~Scope();
+
+        Scope &operator=(const Scope &) = delete;
+
+        void set_tier(Tier) noexcept;
+        void set_limbs(std::size_t) noexcept;
+    };
+
+    template <typename T>
+    class CountingAllocator
+    {
+    public:
+        typedef T value_type;
+
+        CountingAllocator() noexcept = default;
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U> &) noexcept;
+
+        T *allocate(std::size_t);
+        void deallocate(T *, std::size_t) noexcept;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const CountingAllocator<T> &, const CountingAllocator<U> &) noexcept;
+    template <typename T, typename U>
+    bool operator!=(const CountingAllocator<T> &, const CountingAllocator<U> &) noexcept;
+
+    template <typename T>
+    using Allocator = CountingAllocator<T>;
+
+    Counters &local();
+    Snapshot snapshot();
+    void reset();
+    std::ostream &dump(std::ostream &, const Snapshot &);
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<const Counters *> live;
+        Snapshot retired;
+    };
+
+    inline Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    inline void Counters::increase(Counter &counter, unsigned long long value) noexcept
+    {
+        // Only the owning thread writes, so a plain load and store is enough.
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    inline Counters::Counters()
+    {
+        clear();
+        Registry &shared(registry());
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.live.push_back(this);
+    }
+
+    inline Counters::~Counters()
+    {
+        Registry &shared(registry());
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        accumulate(shared.retired);
+        shared.live.erase(std::find(shared.live.begin(), shared.live.end(), this));
+    }
+
+    inline void Counters::record(Operation operation, Tier tier, std::size_t size, unsigned long long time) noexcept
+    {
+        std::size_t bucket(0u);
+        for (; size; size >>= 1u)
+        {
+            ++bucket;
+        }
+        increase(calls[operation][tier], 1u);
+        increase(limbs[operation][bucket], 1u);
+        increase(nanoseconds[operation], time);
+    }
+
+    inline void Counters::record_allocation(std::size_t bytes) noexcept
+    {
+        increase(allocations, 1u);
+        increase(allocated_bytes, bytes);
+    }
+
+    inline void Counters::record_deallocation() noexcept
+    {
+        increase(deallocations, 1u);
+    }
+
+    inline void Counters::accumulate(Snapshot &res) const noexcept
+    {
+        for (std::size_t op = 0u; op < OPERATIONS; ++op)
+        {
+            for (std::size_t tier = 0u; tier < TIERS; ++tier)
+            {
+                res.calls[op][tier] += calls[op][tier].load(std::memory_order_relaxed);
+            }
+            for (std::size_t bucket = 0u; bucket < BUCKETS; ++bucket)
+            {
+                res.limbs[op][bucket] += limbs[op][bucket].load(std::memory_order_relaxed);
+            }
+            res.nanoseconds[op] += nanoseconds[op].load(std::memory_order_relaxed);
+        }
+        res.allocations += allocations.load(std::memory_order_relaxed);
+        res.deallocations += deallocations.load(std::memory_order_relaxed);
+        res.allocated_bytes += allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    inline void Counters::clear() noexcept
+    {
+        for (std::size_t op = 0u; op < OPERATIONS; ++op)
+        {
+            for (std::size_t tier = 0u; tier < TIERS; ++tier)
+            {
+                calls[op][tier].store(0u, std::memory_order_relaxed);
+            }
+            for (std::size_t bucket = 0u; bucket < BUCKETS; ++bucket)
+            {
+                limbs[op][bucket].store(0u, std::memory_order_relaxed);
+            }
+            nanoseconds[op].store(0u, std::memory_order_relaxed);
+        }
+        allocations.store(0u, std::memory_order_relaxed);
+        deallocations.store(0u, std::memory_order_relaxed);
+        allocated_bytes.store(0u, std::memory_order_relaxed);
+    }
+
+    inline Scope::Scope(Operation op, std::size_t size) noexcept : operation(op), tier(SCHOOLBOOK), limbs(size), start(clock::now())
+    {
+    }
+
+    inline Scope::~Scope()
+    {
+        const auto time(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+        local().record(operation, tier, limbs, static_cast<unsigned long long>(time));
+    }
+
+    inline void Scope::set_tier(Tier obj) noexcept
+    {
+        tier = obj;
+    }
+
+    inline void Scope::set_limbs(std::size_t size) noexcept
+    {
+        limbs = size;
+    }
+
+    template <typename T>
+    template <typename U>
+    CountingAllocator<T>::CountingAllocator(const CountingAllocator<U> &) noexcept
+    {
+    }
+
+    template <typename T>
+    T *CountingAllocator<T>::allocate(std::size_t count)
+    {
+        T *res(std::allocator<T>().allocate(count));
+        local().record_allocation(count * sizeof(T));
+
+        return res;
+    }
+
+    template <typename T>
+    void CountingAllocator<T>::deallocate(T *ptr, std::size_t count) noexcept
+    {
+        std::allocator<T>().deallocate(ptr, count);
+        local().record_deallocation();
+    }
+
+    template <typename T, typename U>
+    bool operator==(const CountingAllocator<T> &, const CountingAllocator<U> &) noexcept
+    {
+        return true;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const CountingAllocator<T> &, const CountingAllocator<U> &) noexcept
+    {
+        return false;
+    }
+
+    inline Counters &local()
+    {
+        thread_local Counters counters;
+        return counters;
+    }
+
+    inline Snapshot snapshot()
+    {
+        Registry &shared(registry());
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        Snapshot res(shared.retired);
+        for (const Counters *counters : shared.live)
+        {
+            counters->accumulate(res);
+        }
+
+        return res;
+    }
+
+    // Counters of threads that are running concurrently may keep a few
+    // increments from before the reset.
+    inline void reset()
+    {
+        Registry &shared(registry());
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.retired = Snapshot{};
+        for (const Counters *counters : shared.live)
+        {
+            const_cast<Counters *>(counters)->clear();
+        }
+    }
+
+    // One tab-separated record per line: calls, time, size histogram and heap.
+    inline std::ostream &dump(std::ostream &stream, const Snapshot &obj)
+    {
+        static const char *const operations[OPERATIONS] = {
+            "add", "subtract", "multiply", "divide", "shift", "bitwise", "power", "sqrt", "gcd", "input", "output"
+        };
+        static const char *const tiers[TIERS] = {"trivial", "single_limb", "schoolbook"};
+
+        for (std::size_t op = 0u; op < OPERATIONS; ++op)
+        {
+            for (std::size_t tier = 0u; tier < TIERS; ++tier)
+            {
+                if (obj.calls[op][tier])
+                {
+                    stream << "calls\t" << operations[op] << '\t' << tiers[tier] << '\t' << obj.calls[op][tier] << '\n';
+                }
+            }
+            if (obj.nanoseconds[op])
+            {
+                stream << "nanoseconds\t" << operations[op] << '\t' << obj.nanoseconds[op] << '\n';
+            }
+            for (std::size_t bucket = 0u; bucket < BUCKETS; ++bucket)
+            {
+                if (obj.limbs[op][bucket])
+                {
+                    const std::size_t low(bucket ? std::size_t(1u) << (bucket - 1u) : 0u);
+                    const std::size_t high(bucket ? 2u * low - 1u : 0u);
+                    stream << "limbs\t" << operations[op] << '\t' << low << '-' << high << '\t' << obj.limbs[op][bucket] << '\n';
+                }
+            }
+        }
+        stream << "heap\tallocations\t" << obj.allocations << '\n';
+        stream << "heap\tdeallocations\t" << obj.deallocations << '\n';
+        stream << "heap\tbytes\t" << obj.allocated_bytes << '\n';
+
+        return stream;
+    }
+}
+
+#define BIG_INTEGER_SCOPE(operation, limbs) \
+    big_integer_instrumentation::Scope big_integer_scope(big_integer_instrumentation::operation, (limbs))
+#define BIG_INTEGER_TIER(tier) big_integer_scope.set_tier(big_integer_instrumentation::tier)
+#define BIG_INTEGER_LIMBS(limbs) big_integer_scope.set_limbs(limbs)
+
+#else
+
+namespace big_integer_instrumentation
+{
+    template <typename T>
+    using Allocator = std::allocator<T>;
+}
+
+#define BIG_INTEGER_SCOPE(operation, limbs) static_cast<void>(0)
+#define BIG_INTEGER_TIER(tier) static_cast<void>(0)
+#define BIG_INTEGER_LIMBS(limbs) static_cast<void>(0)
+
+#endif
+
+#endif
@@ -0,0 +1,41 @@
+#include <cstdint>
+
+#include "./kernels.hpp"
+
+#ifndef BIG_INTEGER_KERNEL
+#define BIG_INTEGER_KERNEL generic
+#endif
+
+// This file is compiled with target-specific flags, so it must not pull in
+// inline functions or templates shared with the rest of the library: the
+// linker could keep this copy for every caller.
+namespace big_integer_kernels
+{
+    namespace BIG_INTEGER_KERNEL
+    {
+        void multiply(Integer *res, const Integer *lhs, std::size_t lhs_size, const Integer *rhs, std::size_t rhs_size)
+        {
+            const Integer mask(0xFFFFFFFFu);
+            for (std::size_t j = 0u; j < rhs_size; ++j)
+            {
+                const Integer factor(static_cast<std::uint32_t>(rhs[j]));
+                if (!factor)
+                {
+                    continue;
+                }
+
+                // Limb i of the row takes the low half of lhs[i] * factor and
+                // the high half of lhs[i - 1] * factor, which keeps the loop
+                // free of a carry chain and lets it vectorize.
+                Integer *row(res + j);
+                row[0] += (Integer(static_cast<std::uint32_t>(lhs[0])) * factor) & mask;
+                for (std::size_t i = 1u; i < lhs_size; ++i)
+                {
+                    row[i] += ((Integer(static_cast<std::uint32_t>(lhs[i])) * factor) & mask)
+                        + ((Integer(static_cast<std::uint32_t>(lhs[i - 1u])) * factor) >> 32u);
+                }
+                row[lhs_size] += (Integer(static_cast<std::uint32_t>(lhs[lhs_size - 1u])) * factor) >> 32u;
+            }
+        }
+    }
+}
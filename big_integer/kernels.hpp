@@ -0,0 +1,36 @@
+#ifndef _BIG_INTEGER_KERNELS_H_
+#define _BIG_INTEGER_KERNELS_H_
+
+#include <cstddef>
+
+// Hot loops built once per target: kernels.cpp is compiled several times with
+// different -march flags and BigInteger switches to the best variant the CPU
+// supports while the library is loaded.
+namespace big_integer_kernels
+{
+    typedef unsigned long long Integer;
+
+    // Adds lhs * rhs to res, which holds lhs_size + rhs_size limbs, without
+    // propagating carries. Every row adds less than 2^33 to a limb, so the
+    // caller normalizes afterwards; rhs should be the shorter operand.
+    typedef void (*Multiply)(Integer *, const Integer *, std::size_t, const Integer *, std::size_t);
+
+    namespace generic
+    {
+        void multiply(Integer *, const Integer *, std::size_t, const Integer *, std::size_t);
+    }
+
+    namespace haswell
+    {
+        void multiply(Integer *, const Integer *, std::size_t, const Integer *, std::size_t);
+    }
+
+    namespace skylake_avx512
+    {
+        void multiply(Integer *, const Integer *, std::size_t, const Integer *, std::size_t);
+    }
+
+    extern Multiply multiply;
+}
+
+#endif
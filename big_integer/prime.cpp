@@ -0,0 +1,593 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "./prime.hpp"
+
+constexpr const Montgomery::Integer Montgomery::RADIX;
+
+Montgomery::Montgomery(const BigInteger &obj) : modulus(obj.repres), inverse(0u), r2(), unit(), scratch(obj.repres.size() + 2u)
+{
+    if (modulus.empty() || !(modulus.front() & 1u))
+    {
+        throw std::domain_error("Montgomery modulus must be odd");
+    }
+
+    long long t(0), new_t(1), r(RADIX), new_r(modulus.front()), q;
+    while (new_r)
+    {
+        q = r / new_r;
+        t -= q * new_t;
+        std::swap(t, new_t);
+        r -= q * new_r;
+        std::swap(r, new_r);
+    }
+    if (r != 1)
+    {
+        throw std::domain_error("Montgomery modulus must be coprime to the radix");
+    }
+    inverse = t > 0 ? RADIX - Integer(t) : Integer(-t);
+
+    BigInteger r_square;
+    r_square.repres.resize(2u * modulus.size() + 1u);
+    r_square.repres.back() = 1u;
+    r_square %= obj;
+    r2 = r_square.repres;
+    r2.resize(modulus.size());
+
+    Residue raw(modulus.size());
+    raw.front() = 1u;
+    multiply(unit, raw, r2);
+}
+
+Montgomery::Residue Montgomery::zero() const
+{
+    return Residue(modulus.size());
+}
+
+Montgomery::Residue Montgomery::to_form(const BigInteger &obj) const
+{
+    BigInteger reduced(obj);
+    BigInteger n;
+    n.repres = modulus;
+    reduced %= n;
+
+    Residue raw(reduced.repres), res;
+    raw.resize(modulus.size());
+    multiply(res, raw, r2);
+
+    return res;
+}
+
+BigInteger Montgomery::from_form(const Residue &obj) const
+{
+    Residue raw(modulus.size());
+    raw.front() = 1u;
+
+    BigInteger res;
+    multiply(res.repres, obj, raw);
+    while (!res.repres.empty() && !res.repres.back())
+    {
+        res.repres.pop_back();
+    }
+
+    return res;
+}
+
+void Montgomery::multiply(Residue &res, const Residue &lhs, const Residue &rhs) const
+{
+    const Residue::size_type n(modulus.size());
+    std::fill(scratch.begin(), scratch.end(), 0u);
+
+    Integer *t(scratch.data());
+    const Integer *m_ptr(modulus.data());
+    for (Residue::size_type i = 0u; i < n; ++i)
+    {
+        const Integer a(lhs[i]);
+        Integer carry(0u), sum;
+        for (Residue::size_type j = 0u; j < n; ++j)
+        {
+            sum = t[j] + a * rhs[j] + carry;
+            t[j] = sum % RADIX;
+            carry = sum / RADIX;
+        }
+        sum = t[n] + carry;
+        t[n] = sum % RADIX;
+        t[n + 1u] = sum / RADIX;
+
+        const Integer m((t[0] * inverse) % RADIX);
+        carry = (t[0] + m * m_ptr[0]) / RADIX;
+        for (Residue::size_type j = 1u; j < n; ++j)
+        {
+            sum = t[j] + m * m_ptr[j] + carry;
+            t[j - 1u] = sum % RADIX;
+            carry = sum / RADIX;
+        }
+        sum = t[n] + carry;
+        t[n - 1u] = sum % RADIX;
+        t[n] = t[n + 1u] + sum / RADIX;
+    }
+
+    bool ge(t[n] != 0u);
+    if (!ge)
+    {
+        ge = true;
+        for (Residue::size_type j = n; j-- > 0u;)
+        {
+            if (t[j] != m_ptr[j])
+            {
+                ge = t[j] > m_ptr[j];
+                break;
+            }
+        }
+    }
+    res.resize(n);
+    if (ge)
+    {
+        Integer borrow(0u);
+        for (Residue::size_type j = 0u; j < n; ++j)
+        {
+            Integer sub(m_ptr[j] + borrow);
+            if (t[j] >= sub)
+            {
+                res[j] = t[j] - sub;
+                borrow = 0u;
+            }
+            else
+            {
+                res[j] = t[j] + RADIX - sub;
+                borrow = 1u;
+            }
+        }
+    }
+    else
+    {
+        std::copy(t, t + n, res.begin());
+    }
+}
+
+void Montgomery::add(Residue &res, const Residue &lhs, const Residue &rhs) const
+{
+    const Residue::size_type n(modulus.size());
+    res.resize(n);
+
+    Integer carry(0u);
+    for (Residue::size_type j = 0u; j < n; ++j)
+    {
+        Integer sum(lhs[j] + rhs[j] + carry);
+        carry = sum >= RADIX;
+        res[j] = carry ? sum - RADIX : sum;
+    }
+
+    bool ge(carry != 0u);
+    if (!ge)
+    {
+        ge = true;
+        for (Residue::size_type j = n; j-- > 0u;)
+        {
+            if (res[j] != modulus[j])
+            {
+                ge = res[j] > modulus[j];
+                break;
+            }
+        }
+    }
+    if (ge)
+    {
+        Integer borrow(0u);
+        for (Residue::size_type j = 0u; j < n; ++j)
+        {
+            Integer sub(modulus[j] + borrow);
+            borrow = res[j] < sub;
+            res[j] = borrow ? res[j] + RADIX - sub : res[j] - sub;
+        }
+    }
+}
+
+void Montgomery::subtract(Residue &res, const Residue &lhs, const Residue &rhs) const
+{
+    const Residue::size_type n(modulus.size());
+    res.resize(n);
+
+    Integer borrow(0u);
+    for (Residue::size_type j = 0u; j < n; ++j)
+    {
+        Integer sub(rhs[j] + borrow);
+        borrow = lhs[j] < sub;
+        res[j] = borrow ? lhs[j] + RADIX - sub : lhs[j] - sub;
+    }
+    if (borrow)
+    {
+        Integer carry(0u);
+        for (Residue::size_type j = 0u; j < n; ++j)
+        {
+            Integer sum(res[j] + modulus[j] + carry);
+            carry = sum >= RADIX;
+            res[j] = carry ? sum - RADIX : sum;
+        }
+    }
+}
+
+void Montgomery::half(Residue &obj) const
+{
+    const Residue::size_type n(modulus.size());
+    Integer carry(0u);
+    if (obj.front() & 1u)
+    {
+        for (Residue::size_type j = 0u; j < n; ++j)
+        {
+            Integer sum(obj[j] + modulus[j] + carry);
+            carry = sum >= RADIX;
+            obj[j] = carry ? sum - RADIX : sum;
+        }
+    }
+    for (Residue::size_type j = n; j-- > 0u;)
+    {
+        Integer value(obj[j] + carry * RADIX);
+        obj[j] = value / 2u;
+        carry = value & 1u;
+    }
+}
+
+void Montgomery::power(Residue &res, const Residue &base, const std::vector<bool> &exp) const
+{
+    Residue acc(unit);
+    for (auto it(exp.crbegin()), end(exp.crend()); it != end; ++it)
+    {
+        multiply(acc, acc, acc);
+        if (*it)
+        {
+            multiply(acc, acc, base);
+        }
+    }
+    res = std::move(acc);
+}
+
+std::vector<bool> Montgomery::bits(const BigInteger &obj)
+{
+    std::vector<bool> res(obj.bit_length());
+    for (std::vector<bool>::size_type k = 0u; k < res.size(); ++k)
+    {
+        res[k] = obj.test_bit(k);
+    }
+
+    return res;
+}
+
+namespace prime_detail
+{
+    typedef Montgomery::Integer Integer;
+
+    static constexpr const Integer SIEVE_LIMIT = 2048u;
+
+    struct SmallPrimes
+    {
+        std::vector<Integer> primes;
+        std::vector<Integer> products;
+        std::vector<std::vector<Integer>::size_type> bounds;
+
+        SmallPrimes()
+        {
+            std::vector<bool> composite(SIEVE_LIMIT);
+            for (Integer p = 2u; p < SIEVE_LIMIT; ++p)
+            {
+                if (composite[p])
+                {
+                    continue;
+                }
+                primes.push_back(p);
+                for (Integer q = p * p; q < SIEVE_LIMIT; q += p)
+                {
+                    composite[q] = true;
+                }
+            }
+
+            Integer product(1u);
+            for (std::vector<Integer>::size_type k = 0u; k < primes.size(); ++k)
+            {
+                if (product * primes[k] >= Montgomery::RADIX)
+                {
+                    products.push_back(product);
+                    bounds.push_back(k);
+                    product = 1u;
+                }
+                product *= primes[k];
+            }
+            products.push_back(product);
+            bounds.push_back(primes.size());
+        }
+    };
+
+    inline const SmallPrimes &small_primes()
+    {
+        static const SmallPrimes table;
+        return table;
+    }
+
+    inline int jacobi(Integer a, Integer n)
+    {
+        int res(1);
+        a %= n;
+        while (a)
+        {
+            while (!(a & 1u))
+            {
+                a /= 2u;
+                const Integer r(n % 8u);
+                if (r == 3u || r == 5u)
+                {
+                    res = -res;
+                }
+            }
+            std::swap(a, n);
+            if (a % 4u == 3u && n % 4u == 3u)
+            {
+                res = -res;
+            }
+            a %= n;
+        }
+
+        return n == 1u ? res : 0;
+    }
+}
+
+bool is_prime(const BigInteger &obj, unsigned rounds)
+{
+    typedef prime_detail::Integer Integer;
+    typedef Montgomery::Residue Residue;
+
+    const prime_detail::SmallPrimes &table(prime_detail::small_primes());
+    const bool is_small(obj.repres.size() <= 1u);
+    const Integer value(obj.get(0u));
+    if (is_small && value < 2u)
+    {
+        return false;
+    }
+
+    // Trial division: one pass over the limbs yields the residues modulo
+    // every product of small primes that fits into a limb.
+    std::vector<Integer> residues;
+    obj.remainders(table.products, residues);
+    std::vector<Integer>::size_type k(0u);
+    for (std::vector<Integer>::size_type g = 0u; g < table.products.size(); ++g)
+    {
+        for (; k < table.bounds[g]; ++k)
+        {
+            if (residues[g] % table.primes[k] == 0u)
+            {
+                return is_small && value == table.primes[k];
+            }
+        }
+    }
+    if (is_small && value < prime_detail::SIEVE_LIMIT * prime_detail::SIEVE_LIMIT)
+    {
+        return true;
+    }
+
+    const Montgomery mont(obj);
+    const Residue one(mont.one());
+    Residue minus_one;
+    mont.subtract(minus_one, mont.zero(), one);
+
+    // Strong probable prime test to base 2 and to the extra bases.
+    BigInteger d(obj);
+    --d;
+    unsigned s(0u);
+    while (!(d.repres.front() & 1u))
+    {
+        d >>= 1u;
+        ++s;
+    }
+    const std::vector<bool> d_bits(Montgomery::bits(d));
+    for (unsigned round = 0u; round <= rounds; ++round)
+    {
+        Residue x;
+        mont.power(x, mont.to_form(BigInteger(table.primes[round % table.primes.size()])), d_bits);
+        if (x == one || x == minus_one)
+        {
+            continue;
+        }
+        bool is_witness(true);
+        for (unsigned r = 1u; r < s && is_witness; ++r)
+        {
+            mont.multiply(x, x, x);
+            if (x == minus_one)
+            {
+                is_witness = false;
+            }
+            else if (x == one)
+            {
+                return false;
+            }
+        }
+        if (is_witness)
+        {
+            return false;
+        }
+    }
+
+    // Strong Lucas probable prime test with Selfridge parameters P = 1, Q = (1 - D) / 4.
+    std::vector<Integer> moduli;
+    std::vector<Integer> mod_d;
+    long long selfridge(5);
+    for (unsigned attempt = 0u;; ++attempt)
+    {
+        const Integer abs_d(selfridge > 0 ? selfridge : -selfridge);
+        obj.remainders(std::vector<Integer>{abs_d, 4u}, mod_d);
+        int symbol(prime_detail::jacobi(mod_d[0], abs_d));
+        if (((abs_d - 1u) / 2u) % 2u == 1u && mod_d[1] == 3u)
+        {
+            symbol = -symbol;
+        }
+        if (selfridge < 0 && mod_d[1] == 3u)
+        {
+            symbol = -symbol;
+        }
+        if (symbol == -1)
+        {
+            break;
+        }
+        if (symbol == 0 && !(BigInteger(abs_d) == obj))
+        {
+            return false;
+        }
+        if (attempt == 8u)
+        {
+            const BigInteger root(sqrt(obj));
+            if (root * root == obj)
+            {
+                return false;
+            }
+        }
+        selfridge = selfridge > 0 ? -(selfridge + 2) : -selfridge + 2;
+    }
+
+    const long long q_value((1 - selfridge) / 4);
+    Residue big_d(mont.to_form(BigInteger(Integer(selfridge > 0 ? selfridge : -selfridge))));
+    Residue big_q(mont.to_form(BigInteger(Integer(q_value > 0 ? q_value : -q_value))));
+    if (selfridge < 0)
+    {
+        mont.subtract(big_d, mont.zero(), big_d);
+    }
+    if (q_value < 0)
+    {
+        mont.subtract(big_q, mont.zero(), big_q);
+    }
+
+    BigInteger e(obj);
+    ++e;
+    s = 0u;
+    while (!(e.repres.front() & 1u))
+    {
+        e >>= 1u;
+        ++s;
+    }
+    const std::vector<bool> e_bits(Montgomery::bits(e));
+    Residue u(one), v(one), q_k(big_q), t1, t2;
+    for (auto it(e_bits.crbegin() + 1u), end(e_bits.crend()); it != end; ++it)
+    {
+        mont.multiply(u, u, v);
+        mont.multiply(v, v, v);
+        mont.add(t1, q_k, q_k);
+        mont.subtract(v, v, t1);
+        mont.multiply(q_k, q_k, q_k);
+        if (*it)
+        {
+            mont.add(t1, u, v);
+            mont.half(t1);
+            mont.multiply(t2, big_d, u);
+            mont.add(v, t2, v);
+            mont.half(v);
+            u = std::move(t1);
+            mont.multiply(q_k, q_k, big_q);
+        }
+    }
+
+    const Residue zero(mont.zero());
+    if (u == zero || v == zero)
+    {
+        return true;
+    }
+    for (unsigned r = 1u; r < s; ++r)
+    {
+        mont.multiply(v, v, v);
+        mont.add(t1, q_k, q_k);
+        mont.subtract(v, v, t1);
+        if (v == zero)
+        {
+            return true;
+        }
+        mont.multiply(q_k, q_k, q_k);
+    }
+
+    return false;
+}
+
+BigInteger next_prime(const BigInteger &obj)
+{
+    typedef prime_detail::Integer Integer;
+
+    const prime_detail::SmallPrimes &table(prime_detail::small_primes());
+    BigInteger base(obj);
+    ++base;
+    if (base.repres.size() <= 1u && base.get(0u) <= 2u)
+    {
+        return BigInteger(Integer(2u));
+    }
+    if (!(base.repres.front() & 1u))
+    {
+        ++base;
+    }
+
+    // Sieve candidates base + offset by stepping the small prime residues
+    // instead of dividing every candidate again.
+    std::vector<Integer> group_residues, residues(table.primes.size());
+    base.remainders(table.products, group_residues);
+    std::vector<Integer>::size_type k(0u);
+    for (std::vector<Integer>::size_type g = 0u; g < table.products.size(); ++g)
+    {
+        for (; k < table.bounds[g]; ++k)
+        {
+            residues[k] = group_residues[g] % table.primes[k];
+        }
+    }
+
+    const bool is_small(base.repres.size() <= 1u && base.get(0u) < prime_detail::SIEVE_LIMIT);
+    for (Integer offset = 0u;; offset += 2u)
+    {
+        bool is_candidate(true);
+        for (k = 1u; k < table.primes.size(); ++k)
+        {
+            if (!residues[k] && !(is_small && base.get(0u) + offset == table.primes[k]))
+            {
+                is_candidate = false;
+            }
+            residues[k] += 2u;
+            if (residues[k] >= table.primes[k])
+            {
+                residues[k] -= table.primes[k];
+            }
+        }
+        if (is_candidate)
+        {
+            BigInteger candidate(base + BigInteger(Integer(offset)));
+            if (is_prime(candidate))
+            {
+                return candidate;
+            }
+        }
+    }
+}
+
+std::vector<bool> is_prime(const std::vector<BigInteger> &candidates, unsigned threads, unsigned rounds)
+{
+    if (!threads)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = unsigned(std::min<std::vector<BigInteger>::size_type>(threads, candidates.size()));
+
+    std::vector<char> flags(candidates.size());
+    std::atomic<std::vector<BigInteger>::size_type> next(0u);
+    auto worker = [&]()
+    {
+        for (auto idx(next++); idx < candidates.size(); idx = next++)
+        {
+            flags[idx] = is_prime(candidates[idx], rounds);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1u; t < threads; ++t)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+
+    return std::vector<bool>(flags.cbegin(), flags.cend());
+}
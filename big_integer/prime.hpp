@@ -0,0 +1,50 @@
+#ifndef _PRIME_H_
+#define _PRIME_H_
+
+#include <vector>
+
+#include "./big_integer.hpp"
+
+// Modular arithmetic on residues of a fixed odd modulus in Montgomery form.
+class Montgomery
+{
+public:
+    typedef BigInteger::Integer Integer;
+    typedef BigInteger::Limbs Residue;
+
+    static constexpr const Integer RADIX = BigInteger::RADIX;
+
+private:
+    Residue modulus;
+    Integer inverse;
+    Residue r2;
+    Residue unit;
+    mutable Residue scratch;
+
+public:
+    explicit Montgomery(const BigInteger &);
+
+    Residue zero() const;
+    const Residue &one() const noexcept;
+    Residue to_form(const BigInteger &) const;
+    BigInteger from_form(const Residue &) const;
+
+    void multiply(Residue &, const Residue &, const Residue &) const;
+    void add(Residue &, const Residue &, const Residue &) const;
+    void subtract(Residue &, const Residue &, const Residue &) const;
+    void half(Residue &) const;
+    void power(Residue &, const Residue &, const std::vector<bool> &) const;
+
+    static std::vector<bool> bits(const BigInteger &);
+};
+
+bool is_prime(const BigInteger &, unsigned = 0u);
+BigInteger next_prime(const BigInteger &);
+std::vector<bool> is_prime(const std::vector<BigInteger> &, unsigned = 0u, unsigned = 0u);
+
+inline const Montgomery::Residue &Montgomery::one() const noexcept
+{
+    return unit;
+}
+
+#endif
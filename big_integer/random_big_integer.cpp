@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "./random_big_integer.hpp"
+
+RandomBigInteger::Integer RandomBigInteger::limb()
+{
+    return engine() & BigInteger::MASK;
+}
+
+void RandomBigInteger::trim(BigInteger &obj)
+{
+    while (!obj.repres.empty() && !obj.repres.back())
+    {
+        obj.repres.pop_back();
+    }
+}
+
+RandomBigInteger::RandomBigInteger(std::uint64_t value) : engine(value)
+{
+}
+
+void RandomBigInteger::seed(std::uint64_t value)
+{
+    engine.seed(value);
+}
+
+BigInteger RandomBigInteger::bits(std::size_t count)
+{
+    BigInteger res;
+    res.repres.resize((count + BigInteger::BITS - 1u) / BigInteger::BITS);
+    for (Integer &obj : res.repres)
+    {
+        obj = limb();
+    }
+    if (count % BigInteger::BITS)
+    {
+        res.repres.back() &= (Integer(1u) << (count % BigInteger::BITS)) - 1u;
+    }
+    trim(res);
+
+    return res;
+}
+
+BigInteger RandomBigInteger::exact_bits(std::size_t count)
+{
+    if (!count)
+    {
+        return BigInteger();
+    }
+
+    BigInteger res(bits(count - 1u));
+    res.repres.resize((count + BigInteger::BITS - 1u) / BigInteger::BITS);
+    res.repres.back() |= Integer(1u) << ((count - 1u) % BigInteger::BITS);
+
+    return res;
+}
+
+BigInteger RandomBigInteger::limbs(std::size_t count)
+{
+    BigInteger res;
+    res.repres.resize(count);
+    for (Integer &obj : res.repres)
+    {
+        obj = limb();
+    }
+    while (count && !res.repres.back())
+    {
+        res.repres.back() = limb();
+    }
+
+    return res;
+}
+
+BigInteger RandomBigInteger::below(const BigInteger &obj)
+{
+    if (obj.repres.empty())
+    {
+        throw std::range_error("Empty range");
+    }
+
+    const std::size_t count(obj.bit_length());
+    while (true)
+    {
+        BigInteger res(bits(count));
+        if (res < obj)
+        {
+            return res;
+        }
+    }
+}
+
+BigInteger RandomBigInteger::sparse(std::size_t count, std::size_t ones)
+{
+    if (!count)
+    {
+        return BigInteger();
+    }
+    ones = std::min(std::max(ones, std::size_t(1u)), count);
+
+    BigInteger res;
+    res.repres.resize((count + BigInteger::BITS - 1u) / BigInteger::BITS);
+    res.repres.back() |= Integer(1u) << ((count - 1u) % BigInteger::BITS);
+    for (std::size_t set = 1u; set < ones; )
+    {
+        const std::size_t idx(std::size_t(engine() % (count - 1u)));
+        Integer &obj(res.repres[idx / BigInteger::BITS]);
+        const Integer bit(Integer(1u) << (idx % BigInteger::BITS));
+        if (!(obj & bit))
+        {
+            obj |= bit;
+            ++set;
+        }
+    }
+
+    return res;
+}
+
+BigInteger RandomBigInteger::adversarial(std::size_t count)
+{
+    static const Integer patterns[] = {BigInteger::MASK, 0u, 1u, BigInteger::HALF_OF_RADIX, BigInteger::MASK - 1u};
+
+    BigInteger res;
+    res.repres.resize(count);
+    for (std::size_t i = 0u; i < count; )
+    {
+        const std::size_t run(std::min(std::size_t(1u + engine() % 16u), count - i));
+        const Integer value(engine() % 8u < 5u ? patterns[engine() % 5u] : limb());
+        std::fill(res.repres.begin() + i, res.repres.begin() + i + run, value);
+        i += run;
+    }
+    if (count && !res.repres.back())
+    {
+        res.repres.back() = BigInteger::MASK;
+    }
+
+    return res;
+}
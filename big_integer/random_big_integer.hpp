@@ -0,0 +1,41 @@
+#ifndef _RANDOM_BIG_INTEGER_H_
+#define _RANDOM_BIG_INTEGER_H_
+
+#include <cstdint>
+#include <random>
+
+#include "./big_integer.hpp"
+
+// Seeded BigInteger generator that fills limbs directly. The engine is
+// std::mt19937_64, so a seed yields the same sequence on every platform.
+class RandomBigInteger
+{
+private:
+    typedef BigInteger::Integer Integer;
+
+    std::mt19937_64 engine;
+
+    Integer limb();
+    static void trim(BigInteger &);
+
+public:
+    explicit RandomBigInteger(std::uint64_t = 0u);
+
+    void seed(std::uint64_t);
+
+    // Uniform in [0, 2^count).
+    BigInteger bits(std::size_t);
+    // Uniform among values with exactly count bits.
+    BigInteger exact_bits(std::size_t);
+    // Uniform among values with exactly count limbs.
+    BigInteger limbs(std::size_t);
+    // Uniform in [0, obj), by rejection; obj must be positive.
+    BigInteger below(const BigInteger &);
+    // Exactly count bits with ones bits set, the top one included.
+    BigInteger sparse(std::size_t, std::size_t);
+    // Exactly count limbs in runs of all-ones, zero and single-bit limbs,
+    // which drive long carry and borrow chains and quotient corrections.
+    BigInteger adversarial(std::size_t);
+};
+
+#endif
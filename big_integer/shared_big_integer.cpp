@@ -0,0 +1,131 @@
+#include <utility>
+
+#include "./shared_big_integer.hpp"
+
+BigInteger &SharedBigInteger::mutate()
+{
+    if (value.use_count() != 1)
+    {
+        value = std::make_shared<BigInteger>(static_cast<const BigInteger &>(*value));
+    }
+
+    return *value;
+}
+
+SharedBigInteger::SharedBigInteger() : value(std::make_shared<BigInteger>())
+{
+}
+
+SharedBigInteger::SharedBigInteger(const BigInteger &obj) : value(std::make_shared<BigInteger>(obj))
+{
+}
+
+SharedBigInteger::SharedBigInteger(BigInteger &&obj) : value(std::make_shared<BigInteger>(std::move(obj)))
+{
+}
+
+SharedBigInteger &SharedBigInteger::operator++()
+{
+    ++mutate();
+
+    return *this;
+}
+
+SharedBigInteger &SharedBigInteger::operator--()
+{
+    --mutate();
+
+    return *this;
+}
+
+SharedBigInteger &SharedBigInteger::operator+=(const SharedBigInteger &obj)
+{
+    if (unique())
+    {
+        *value += *obj.value;
+    }
+    else
+    {
+        value = std::make_shared<BigInteger>(*value + *obj.value);
+    }
+
+    return *this;
+}
+
+SharedBigInteger &SharedBigInteger::operator-=(const SharedBigInteger &obj)
+{
+    if (unique())
+    {
+        *value -= *obj.value;
+    }
+    else
+    {
+        value = std::make_shared<BigInteger>(*value - *obj.value);
+    }
+
+    return *this;
+}
+
+SharedBigInteger &SharedBigInteger::operator*=(const SharedBigInteger &obj)
+{
+    if (unique())
+    {
+        *value *= *obj.value;
+    }
+    else
+    {
+        value = std::make_shared<BigInteger>(*value * *obj.value);
+    }
+
+    return *this;
+}
+
+SharedBigInteger &SharedBigInteger::operator/=(const SharedBigInteger &obj)
+{
+    if (unique())
+    {
+        *value /= *obj.value;
+    }
+    else
+    {
+        value = std::make_shared<BigInteger>(*value / *obj.value);
+    }
+
+    return *this;
+}
+
+SharedBigInteger SharedBigInteger::operator+(const SharedBigInteger &obj) const
+{
+    return SharedBigInteger(*value + *obj.value);
+}
+
+SharedBigInteger SharedBigInteger::operator-(const SharedBigInteger &obj) const
+{
+    return SharedBigInteger(*value - *obj.value);
+}
+
+SharedBigInteger SharedBigInteger::operator*(const SharedBigInteger &obj) const
+{
+    return SharedBigInteger(*value * *obj.value);
+}
+
+SharedBigInteger SharedBigInteger::operator/(const SharedBigInteger &obj) const
+{
+    return SharedBigInteger(*value / *obj.value);
+}
+
+std::ostream &operator<<(std::ostream &stream, const SharedBigInteger &obj)
+{
+    stream << *obj.value;
+
+    return stream;
+}
+
+std::istream &operator>>(std::istream &stream, SharedBigInteger &obj)
+{
+    BigInteger temp;
+    stream >> temp;
+    obj.value = std::make_shared<BigInteger>(std::move(temp));
+
+    return stream;
+}
@@ -0,0 +1,97 @@
+#ifndef _SHARED_BIG_INTEGER_H_
+#define _SHARED_BIG_INTEGER_H_
+
+#include <iostream>
+#include <memory>
+
+#include "./big_integer.hpp"
+
+// Copy-on-write handle: copies share one immutable BigInteger, the limbs are
+// cloned only when a shared value is modified.
+class SharedBigInteger
+{
+private:
+    std::shared_ptr<BigInteger> value;
+
+    BigInteger &mutate();
+
+public:
+    SharedBigInteger();
+    SharedBigInteger(const SharedBigInteger &) = default;
+    SharedBigInteger(SharedBigInteger &&) noexcept = default;
+    SharedBigInteger(const BigInteger &);
+    SharedBigInteger(BigInteger &&);
+
+    ~SharedBigInteger() = default;
+
+    SharedBigInteger &operator=(const SharedBigInteger &) = default;
+    SharedBigInteger &operator=(SharedBigInteger &&) noexcept = default;
+
+    const BigInteger &get() const noexcept;
+    operator const BigInteger &() const noexcept;
+    bool unique() const noexcept;
+
+    bool operator<(const SharedBigInteger &) const noexcept;
+    bool operator<=(const SharedBigInteger &) const noexcept;
+    bool operator==(const SharedBigInteger &) const noexcept;
+    bool operator>=(const SharedBigInteger &) const noexcept;
+    bool operator>(const SharedBigInteger &) const noexcept;
+
+    SharedBigInteger &operator++();
+    SharedBigInteger &operator--();
+
+    SharedBigInteger &operator+=(const SharedBigInteger &);
+    SharedBigInteger &operator-=(const SharedBigInteger &);
+    SharedBigInteger &operator*=(const SharedBigInteger &);
+    SharedBigInteger &operator/=(const SharedBigInteger &);
+
+    SharedBigInteger operator+(const SharedBigInteger &) const;
+    SharedBigInteger operator-(const SharedBigInteger &) const;
+    SharedBigInteger operator*(const SharedBigInteger &) const;
+    SharedBigInteger operator/(const SharedBigInteger &) const;
+
+    friend std::ostream &operator<<(std::ostream &, const SharedBigInteger &);
+    friend std::istream &operator>>(std::istream &, SharedBigInteger &);
+};
+
+inline const BigInteger &SharedBigInteger::get() const noexcept
+{
+    return *value;
+}
+
+inline SharedBigInteger::operator const BigInteger &() const noexcept
+{
+    return *value;
+}
+
+inline bool SharedBigInteger::unique() const noexcept
+{
+    return value.use_count() == 1;
+}
+
+inline bool SharedBigInteger::operator<(const SharedBigInteger &obj) const noexcept
+{
+    return *value < *obj.value;
+}
+
+inline bool SharedBigInteger::operator<=(const SharedBigInteger &obj) const noexcept
+{
+    return *value <= *obj.value;
+}
+
+inline bool SharedBigInteger::operator==(const SharedBigInteger &obj) const noexcept
+{
+    return value == obj.value || *value == *obj.value;
+}
+
+inline bool SharedBigInteger::operator>=(const SharedBigInteger &obj) const noexcept
+{
+    return *value >= *obj.value;
+}
+
+inline bool SharedBigInteger::operator>(const SharedBigInteger &obj) const noexcept
+{
+    return *value > *obj.value;
+}
+
+#endif
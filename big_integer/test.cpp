@@ -1,20 +1,39 @@
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "big_integer.hpp"
 
-int main()
+// Reads "first second op" records in large blocks, evaluates chunks of whole
+// records on a worker pool and writes the results in input order.
+//
+// Usage: test [threads]
+
+static constexpr const std::size_t BLOCK_SIZE = 1u << 20u;
+static constexpr const std::size_t CHUNK_SIZE = 1u << 16u;
+static constexpr const std::size_t MAX_PENDING_CHUNKS = 256u;
+
+void evaluate(std::istream &input, std::ostream &output)
 {
-    std::ios_base::sync_with_stdio(false);
-    std::cout << std::boolalpha;
+    output << std::boolalpha;
 
     BigInteger first, second;
     char op;
 
     while (true)
     {
-        std::cin >> first >> second;
-        std::cin >> op;
-        if (!std::cin)
+        input >> first >> second;
+        input >> op;
+        if (!input)
         {
             break;
         }
@@ -22,24 +41,24 @@ int main()
         {
             case '*':
             {
-                std::cout << first * second << "\n";
+                output << first * second << "\n";
                 break;
             }
             case '+':
             {
                 first += second;
-                std::cout << first << "\n";
+                output << first << "\n";
                 break;
             }
             case '-':
             {
                 try {
                     first -= second;
-                    std::cout << first << "\n";
+                    output << first << "\n";
                 }
                 catch (const std::exception &except)
                 {
-                    std::cout << "Error\n";
+                    output << "Error\n";
                 }
                 break;
             }
@@ -47,40 +66,217 @@ int main()
             {
                 try {
                     first /= second;
-                    std::cout << first << "\n";
+                    output << first << "\n";
                 }
                 catch (const std::exception &except)
                 {
-                    std::cout << "Error\n";
+                    output << "Error\n";
                 }
                 break;
             }
             case '>':
             {
-                std::cout << (first > second) << "\n";
+                output << (first > second) << "\n";
                 break;
             }
             case '=':
             {
-                std::cout << (first == second) << "\n";
+                output << (first == second) << "\n";
                 break;
             }
             case '<':
             {
-                std::cout << (first < second) << "\n";
+                output << (first < second) << "\n";
                 break;
             }
             case '^':
             {
                 try {
-                    std::cout << power_eq(first, second) << "\n";
+                    output << power_eq(first, second) << "\n";
                 }
                 catch (const std::exception &except)
                 {
-                    std::cout << "Error\n";
+                    output << "Error\n";
                 }
                 break;
             }
         }
     }
 }
+
+// Offset just past the record starting at pos, or npos when the text ends
+// before the record is complete. A record is two tokens and one operator
+// character, exactly what evaluate() extracts per iteration.
+std::string::size_type record_end(const std::string &text, std::string::size_type pos)
+{
+    const std::string::size_type size(text.size());
+    for (unsigned token = 0u; token < 2u; ++token)
+    {
+        while (pos < size && std::isspace(static_cast<unsigned char>(text[pos])))
+        {
+            ++pos;
+        }
+        while (pos < size && !std::isspace(static_cast<unsigned char>(text[pos])))
+        {
+            ++pos;
+        }
+        if (pos == size)
+        {
+            return std::string::npos;
+        }
+    }
+    while (pos < size && std::isspace(static_cast<unsigned char>(text[pos])))
+    {
+        ++pos;
+    }
+
+    return pos < size ? pos + 1u : std::string::npos;
+}
+
+class Pipeline
+{
+private:
+    struct Chunk
+    {
+        std::string text;
+        bool done;
+    };
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Chunk> chunks;
+    std::size_t first_index;
+    std::size_t next_index;
+    bool finished;
+
+    void work();
+    void write(std::ostream &);
+
+public:
+    Pipeline();
+
+    void push(std::string &&);
+    void run(std::istream &, std::ostream &, unsigned);
+};
+
+Pipeline::Pipeline() : mutex(), changed(), chunks(), first_index(0u), next_index(0u), finished(false)
+{
+}
+
+void Pipeline::push(std::string &&text)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return chunks.size() < MAX_PENDING_CHUNKS; });
+    chunks.push_back(Chunk{std::move(text), false});
+    changed.notify_all();
+}
+
+void Pipeline::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this]() { return finished || next_index < first_index + chunks.size(); });
+        if (next_index == first_index + chunks.size())
+        {
+            return;
+        }
+
+        // References into a deque survive pushes and pops at the other end,
+        // and the writer never pops a chunk that is not done.
+        Chunk &chunk(chunks[next_index - first_index]);
+        ++next_index;
+        lock.unlock();
+
+        std::istringstream input(chunk.text);
+        std::ostringstream output;
+        evaluate(input, output);
+
+        lock.lock();
+        chunk.text = output.str();
+        chunk.done = true;
+        changed.notify_all();
+    }
+}
+
+void Pipeline::write(std::ostream &stream)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this]() { return (!chunks.empty() && chunks.front().done) || (finished && chunks.empty()); });
+        if (chunks.empty())
+        {
+            return;
+        }
+
+        const std::string text(std::move(chunks.front().text));
+        chunks.pop_front();
+        ++first_index;
+        changed.notify_all();
+        lock.unlock();
+
+        stream.write(text.data(), text.size());
+
+        lock.lock();
+    }
+}
+
+void Pipeline::run(std::istream &input, std::ostream &output, unsigned threads)
+{
+    std::vector<std::thread> workers;
+    for (unsigned i = 0u; i < threads; ++i)
+    {
+        workers.emplace_back(&Pipeline::work, this);
+    }
+    std::thread writer(&Pipeline::write, this, std::ref(output));
+
+    std::vector<char> block(BLOCK_SIZE);
+    std::string pending;
+    while (input)
+    {
+        input.read(block.data(), block.size());
+        pending.append(block.data(), input.gcount());
+
+        std::string::size_type start(0u), end(0u), next;
+        while ((next = record_end(pending, end)) != std::string::npos)
+        {
+            end = next;
+            if (end - start >= CHUNK_SIZE)
+            {
+                push(pending.substr(start, end - start));
+                start = end;
+            }
+        }
+        if (end > start)
+        {
+            push(pending.substr(start, end - start));
+        }
+        pending.erase(0u, end);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+        changed.notify_all();
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    writer.join();
+    output.flush();
+}
+
+int main(int argc, char **argv)
+{
+    std::ios_base::sync_with_stdio(false);
+
+    unsigned threads(argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : std::thread::hardware_concurrency());
+    threads = std::max(threads, 1u);
+
+    Pipeline pipeline;
+    pipeline.run(std::cin, std::cout, threads);
+
+    return 0;
+}
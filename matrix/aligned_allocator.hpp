@@ -0,0 +1,75 @@
+#ifndef __ALIGNED_ALLOCATOR_HPP__
+#define __ALIGNED_ALLOCATOR_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+// Standard allocator whose blocks start on an Alignment-byte boundary. The
+// original pointer is kept just below the aligned block.
+template <typename T, std::size_t Alignment = 64u>
+class AlignedAllocator
+{
+    static_assert(Alignment && !(Alignment & (Alignment - 1u)), "Alignment must be a power of two");
+
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept;
+
+    T *allocate(std::size_t);
+    void deallocate(T *, std::size_t) noexcept;
+};
+
+template <typename T, std::size_t Alignment>
+template <typename U>
+AlignedAllocator<T, Alignment>::AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept
+{
+}
+
+template <typename T, std::size_t Alignment>
+T *AlignedAllocator<T, Alignment>::allocate(const std::size_t count)
+{
+    if (count > (std::numeric_limits<std::size_t>::max() - Alignment - sizeof(void *)) / sizeof(T))
+    {
+        throw std::bad_alloc();
+    }
+
+    void *const raw = ::operator new(count * sizeof(T) + Alignment + sizeof(void *));
+    const std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *) + Alignment - 1u) & ~std::uintptr_t(Alignment - 1u);
+    reinterpret_cast<void **>(address)[-1] = raw;
+
+    return reinterpret_cast<T *>(address);
+}
+
+template <typename T, std::size_t Alignment>
+void AlignedAllocator<T, Alignment>::deallocate(T *const ptr, const std::size_t) noexcept
+{
+    if (ptr)
+    {
+        ::operator delete(reinterpret_cast<void **>(ptr)[-1]);
+    }
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator ==(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) noexcept
+{
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator !=(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) noexcept
+{
+    return false;
+}
+
+#endif
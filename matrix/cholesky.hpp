@@ -0,0 +1,211 @@
+#ifndef __CHOLESKY_HPP__
+#define __CHOLESKY_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "./matrix_complex.hpp"
+#include "./task_graph.hpp"
+
+// A = L * L^H for Hermitian positive definite A, reading only its lower
+// triangle. The matrix is cut into tile_size x tile_size tiles and every step
+// of the tiled algorithm is one task on a TaskGraph: factoring diagonal tile
+// k, solving tile (i, k) against it, and subtracting L(i, k) * L(j, k)^H from
+// tile (i, j). Updates of iteration k therefore run while the panel of
+// iteration k + 1 is being factored.
+template <typename T>
+class Cholesky
+{
+public:
+    typedef Matrix<T> matrix_type;
+    typedef typename matrix_type::value_type value_type;
+    typedef typename matrix_type::size_type size_type;
+    typedef typename std::decay<decltype(std::abs(value_type()))>::type magnitude_type;
+
+    static constexpr const size_type tile_size = 128u;
+
+private:
+    matrix_type factor;
+
+    static void factor_tile(size_type, value_type *, size_type);
+    static void solve_tile(size_type, size_type, const value_type *, size_type, value_type *, size_type);
+    static void update_tile(size_type, size_type, size_type, const value_type *, const value_type *, size_type,
+        value_type *, size_type);
+
+public:
+    explicit Cholesky(matrix_type);
+
+    const matrix_type &matrix() const;
+    matrix_type solve(const matrix_type &) const;
+};
+
+template <typename T>
+constexpr const typename Cholesky<T>::size_type Cholesky<T>::tile_size;
+
+template <typename T>
+Cholesky<T>::Cholesky(matrix_type obj) : factor(std::move(obj))
+{
+    const size_type n = factor.size1();
+    if (n != factor.size2())
+    {
+        throw std::domain_error("Matrix isn't square");
+    }
+
+    const size_type tiles = (n + tile_size - 1u) / tile_size, lda = factor.stride();
+    value_type *const a = factor.data();
+    TaskGraph graph;
+    for (size_type k = 0u; k < tiles; ++k)
+    {
+        const size_type kk = k * tile_size, bk = std::min(tile_size, n - kk);
+        graph.add([=]() { factor_tile(bk, a + kk * lda + kk, lda); }, {}, {k * tiles + k}, 2);
+        for (size_type i = k + 1u; i < tiles; ++i)
+        {
+            const size_type ii = i * tile_size, bi = std::min(tile_size, n - ii);
+            graph.add([=]() { solve_tile(bi, bk, a + kk * lda + kk, lda, a + ii * lda + kk, lda); },
+                {k * tiles + k}, {i * tiles + k}, 1);
+        }
+        for (size_type i = k + 1u; i < tiles; ++i)
+        {
+            const size_type ii = i * tile_size, bi = std::min(tile_size, n - ii);
+            for (size_type j = k + 1u; j <= i; ++j)
+            {
+                const size_type jj = j * tile_size, bj = std::min(tile_size, n - jj);
+                graph.add([=]() { update_tile(bi, bj, bk, a + ii * lda + kk, a + jj * lda + kk, lda, a + ii * lda + jj, lda); },
+                    {i * tiles + k, j * tiles + k}, {i * tiles + j}, j == k + 1u ? 1 : 0);
+            }
+        }
+    }
+    graph.run(tiles > 1u ? matrix_kernels::pool() : nullptr);
+
+    for (size_type i = 0u; i < n; ++i)
+    {
+        std::fill(a + i * lda + i + 1u, a + i * lda + n, value_type());
+    }
+}
+
+// Unblocked, row by row: L(j, j) from the squared norm of the row so far,
+// then column j of the rows below it.
+template <typename T>
+void Cholesky<T>::factor_tile(const size_type b, value_type *const a, const size_type lda)
+{
+    for (size_type j = 0u; j < b; ++j)
+    {
+        value_type *const row = a + j * lda;
+        magnitude_type d = std::real(row[j]);
+        for (size_type p = 0u; p < j; ++p)
+        {
+            d -= std::norm(row[p]);
+        }
+        if (!(d > magnitude_type()))
+        {
+            throw std::domain_error("Matrix isn't positive definite");
+        }
+
+        const magnitude_type diagonal = std::sqrt(d);
+        row[j] = diagonal;
+        for (size_type i = j + 1u; i < b; ++i)
+        {
+            value_type *const target = a + i * lda;
+            value_type s = target[j];
+            for (size_type p = 0u; p < j; ++p)
+            {
+                s -= target[p] * matrix_kernels::conjugate(row[p]);
+            }
+            target[j] = s / diagonal;
+        }
+    }
+}
+
+// X[m x b] = X * L^-H for the factored diagonal tile L, one row at a time.
+template <typename T>
+void Cholesky<T>::solve_tile(const size_type m, const size_type b, const value_type *const l, const size_type ldl,
+    value_type *const x, const size_type ldx)
+{
+    for (size_type i = 0u; i < m; ++i)
+    {
+        value_type *const row = x + i * ldx;
+        for (size_type j = 0u; j < b; ++j)
+        {
+            const value_type *const diagonal_row = l + j * ldl;
+            value_type s = row[j];
+            for (size_type p = 0u; p < j; ++p)
+            {
+                s -= row[p] * matrix_kernels::conjugate(diagonal_row[p]);
+            }
+            row[j] = s / std::real(diagonal_row[j]);
+        }
+    }
+}
+
+// C[m x n] -= A[m x l] * B[n x l]^H, on the calling thread.
+template <typename T>
+void Cholesky<T>::update_tile(const size_type m, const size_type n, const size_type l,
+    const value_type *const a, const value_type *const b, const size_type ld, value_type *const c, const size_type ldc)
+{
+    const std::ptrdiff_t stride = std::ptrdiff_t(ld);
+    matrix_kernels::serial_gemm(matrix_kernels::kernel<value_type>(), m, n, l, value_type(-1),
+        a, stride, 1, false, b, 1, stride, true, c, ldc);
+}
+
+template <typename T>
+const typename Cholesky<T>::matrix_type &Cholesky<T>::matrix() const
+{
+    return factor;
+}
+
+// X with A * X = B: L * Y = B forward, then L^H * X = Y backward, in blocks
+// of tile_size rows with one gemm update per block.
+template <typename T>
+typename Cholesky<T>::matrix_type Cholesky<T>::solve(const matrix_type &rhs) const
+{
+    const size_type n = factor.size1();
+    if (rhs.size1() != n)
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    matrix_type result(rhs);
+    const size_type m = result.size2(), lda = factor.stride(), ldx = result.stride();
+    const value_type *const a = factor.data();
+    value_type *const x = result.data();
+    for (size_type k = 0u; k < n; k += tile_size)
+    {
+        const size_type b = std::min(tile_size, n - k);
+        for (size_type i = k; i < k + b; ++i)
+        {
+            for (size_type p = k; p < i; ++p)
+            {
+                result.row_addition(i, -a[i * lda + p], p);
+            }
+            result.row_multiplication(value_type(1) / a[i * lda + i], i);
+        }
+        matrix_kernels::gemm(n - k - b, m, b, value_type(-1),
+            a + (k + b) * lda + k, lda, 1, x + k * ldx, ldx, 1, x + (k + b) * ldx, ldx);
+    }
+
+    for (size_type end = n; end > 0u;)
+    {
+        const size_type k = (end - 1u) / tile_size * tile_size;
+        for (size_type i = end; i-- > k;)
+        {
+            for (size_type p = i + 1u; p < end; ++p)
+            {
+                result.row_addition(i, -matrix_kernels::conjugate(a[p * lda + i]), p);
+            }
+            result.row_multiplication(value_type(1) / a[i * lda + i], i);
+        }
+        // Rows 0 to k of L^H are the conjugated columns 0 to k of L.
+        matrix_kernels::gemm(k, m, end - k, value_type(-1),
+            a + k * lda, 1, lda, x + k * ldx, ldx, 1, x, ldx, true);
+        end = k;
+    }
+
+    return result;
+}
+
+#endif
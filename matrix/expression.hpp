@@ -0,0 +1,612 @@
+#ifndef __MATRIX_EXPRESSION_HPP__
+#define __MATRIX_EXPRESSION_HPP__
+
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "./strassen.hpp"
+
+// Matrix<T> has its dimensions set at run time; Matrix<T, R, C> is fixed at
+// R x C (fixed_matrix.hpp).
+constexpr const std::size_t dynamic_size = std::numeric_limits<std::size_t>::max();
+
+template <typename T, std::size_t R = dynamic_size, std::size_t C = dynamic_size>
+class Matrix;
+template <typename T>
+class ConstMatrixView;
+
+// Lazy matrix arithmetic. +, -, unary -, and scalar * and / build expression
+// nodes instead of matrices; assigning a node to a Matrix evaluates it in a
+// single pass over the destination. All of these operations are linear, so
+// an expression is a combination of plain matrices and products: the pass
+// computes the matrix terms while products contribute zero, and every
+// product is then added by one gemm whose alpha is its coefficient.
+//
+// Leaves are anything laid out like a Matrix, element (i, j) at
+// data()[i * stride() + j]: matrices and views. A destination whose storage
+// is read by a product, or by a leaf laid out differently from it, is
+// evaluated through a temporary.
+//
+// Nodes keep references to the matrices they were built from, so they must
+// be evaluated within the full expression that creates them (do not store
+// one in an auto variable).
+namespace matrix_expressions
+{
+    template <typename E>
+    struct is_expression : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_expression<Matrix<T>> : std::true_type
+    {
+    };
+
+    template <typename M>
+    class Leaf
+    {
+    private:
+        const M &matrix;
+
+    public:
+        typedef typename M::value_type value_type;
+        typedef typename M::size_type size_type;
+
+        explicit Leaf(const M &);
+
+        const M &get() const;
+        size_type size1() const;
+        size_type size2() const;
+        value_type element(size_type, size_type) const;
+        template <typename D>
+        void accumulate(D &, const value_type &) const;
+        template <typename D>
+        bool references(const D &) const;
+        template <typename D>
+        bool aliases(const D &) const;
+    };
+
+    // Matrices are held through a Leaf, nodes by value.
+    template <typename E>
+    struct operand
+    {
+        typedef E type;
+    };
+
+    template <typename T>
+    struct operand<Matrix<T>>
+    {
+        typedef Leaf<Matrix<T>> type;
+    };
+
+    template <typename L, typename R, bool Subtract>
+    class Sum
+    {
+    private:
+        typename operand<L>::type left;
+        typename operand<R>::type right;
+
+    public:
+        typedef typename L::value_type value_type;
+        typedef typename L::size_type size_type;
+
+        Sum(const L &, const R &);
+
+        size_type size1() const;
+        size_type size2() const;
+        value_type element(size_type, size_type) const;
+        template <typename D>
+        void accumulate(D &, const value_type &) const;
+        template <typename D>
+        bool references(const D &) const;
+        template <typename D>
+        bool aliases(const D &) const;
+    };
+
+    template <typename E, bool Divide>
+    class Scaled
+    {
+    private:
+        typename operand<E>::type expression;
+        typename E::value_type value;
+
+    public:
+        typedef typename E::value_type value_type;
+        typedef typename E::size_type size_type;
+
+        Scaled(const E &, const value_type &);
+
+        size_type size1() const;
+        size_type size2() const;
+        value_type element(size_type, size_type) const;
+        template <typename D>
+        void accumulate(D &, const value_type &) const;
+        template <typename D>
+        bool references(const D &) const;
+        template <typename D>
+        bool aliases(const D &) const;
+    };
+
+    template <typename E>
+    class Negation
+    {
+    private:
+        typename operand<E>::type expression;
+
+    public:
+        typedef typename E::value_type value_type;
+        typedef typename E::size_type size_type;
+
+        explicit Negation(const E &);
+
+        size_type size1() const;
+        size_type size2() const;
+        value_type element(size_type, size_type) const;
+        template <typename D>
+        void accumulate(D &, const value_type &) const;
+        template <typename D>
+        bool references(const D &) const;
+        template <typename D>
+        bool aliases(const D &) const;
+    };
+
+    template <typename L, typename R>
+    class Product
+    {
+    private:
+        typename operand<L>::type left;
+        typename operand<R>::type right;
+
+    public:
+        typedef typename L::value_type value_type;
+        typedef typename L::size_type size_type;
+        typedef Matrix<value_type> matrix_type;
+
+        Product(const L &, const R &);
+
+        size_type size1() const;
+        size_type size2() const;
+        value_type element(size_type, size_type) const;
+        template <typename D>
+        void accumulate(D &, const value_type &) const;
+        template <typename D>
+        void assign(D &) const;
+        template <typename D>
+        bool references(const D &) const;
+        template <typename D>
+        bool aliases(const D &) const;
+    };
+
+    template <typename L, typename R, bool Subtract>
+    struct is_expression<Sum<L, R, Subtract>> : std::true_type
+    {
+    };
+
+    template <typename E, bool Divide>
+    struct is_expression<Scaled<E, Divide>> : std::true_type
+    {
+    };
+
+    template <typename E>
+    struct is_expression<Negation<E>> : std::true_type
+    {
+    };
+
+    template <typename L, typename R>
+    struct is_expression<Product<L, R>> : std::true_type
+    {
+    };
+
+    template <typename M, typename N>
+    bool overlaps(const M &, const N &);
+
+    template <typename M, typename S>
+    ConstMatrixView<typename M::value_type> materialize(const Leaf<M> &, S &);
+    template <typename E, typename S>
+    ConstMatrixView<typename E::value_type> materialize(const E &, S &);
+
+    template <typename D, typename E>
+    void assign(D &, const E &);
+    template <typename D, typename L, typename R>
+    void assign(D &, const Product<L, R> &);
+    template <typename D, typename E>
+    void add(D &, const E &, bool);
+
+    template <typename M>
+    Leaf<M>::Leaf(const M &obj) : matrix(obj)
+    {
+    }
+
+    template <typename M>
+    const M &Leaf<M>::get() const
+    {
+        return matrix;
+    }
+
+    template <typename M>
+    typename Leaf<M>::size_type Leaf<M>::size1() const
+    {
+        return matrix.size1();
+    }
+
+    template <typename M>
+    typename Leaf<M>::size_type Leaf<M>::size2() const
+    {
+        return matrix.size2();
+    }
+
+    template <typename M>
+    typename Leaf<M>::value_type Leaf<M>::element(const size_type i, const size_type j) const
+    {
+        return matrix.data()[i * matrix.stride() + j];
+    }
+
+    template <typename M>
+    template <typename D>
+    void Leaf<M>::accumulate(D &, const value_type &) const
+    {
+    }
+
+    template <typename M>
+    template <typename D>
+    bool Leaf<M>::references(const D &target) const
+    {
+        return overlaps(matrix, target);
+    }
+
+    // A leaf laid out exactly like the destination is read at each position
+    // before that position is written.
+    template <typename M>
+    template <typename D>
+    bool Leaf<M>::aliases(const D &target) const
+    {
+        return references(target) && !(matrix.data() == target.data() && matrix.stride() == target.stride());
+    }
+
+    template <typename L, typename R, bool Subtract>
+    Sum<L, R, Subtract>::Sum(const L &lhs, const R &rhs) : left(lhs), right(rhs)
+    {
+        if (left.size1() != right.size1() || left.size2() != right.size2())
+        {
+            throw std::domain_error(Subtract ? "Matrices can't be subtracted" : "Matrices can't be summed");
+        }
+    }
+
+    template <typename L, typename R, bool Subtract>
+    typename Sum<L, R, Subtract>::size_type Sum<L, R, Subtract>::size1() const
+    {
+        return left.size1();
+    }
+
+    template <typename L, typename R, bool Subtract>
+    typename Sum<L, R, Subtract>::size_type Sum<L, R, Subtract>::size2() const
+    {
+        return left.size2();
+    }
+
+    template <typename L, typename R, bool Subtract>
+    typename Sum<L, R, Subtract>::value_type Sum<L, R, Subtract>::element(const size_type i, const size_type j) const
+    {
+        return Subtract ? left.element(i, j) - right.element(i, j) : left.element(i, j) + right.element(i, j);
+    }
+
+    template <typename L, typename R, bool Subtract>
+    template <typename D>
+    void Sum<L, R, Subtract>::accumulate(D &target, const value_type &alpha) const
+    {
+        left.accumulate(target, alpha);
+        right.accumulate(target, Subtract ? -alpha : alpha);
+    }
+
+    template <typename L, typename R, bool Subtract>
+    template <typename D>
+    bool Sum<L, R, Subtract>::references(const D &target) const
+    {
+        return left.references(target) || right.references(target);
+    }
+
+    template <typename L, typename R, bool Subtract>
+    template <typename D>
+    bool Sum<L, R, Subtract>::aliases(const D &target) const
+    {
+        return left.aliases(target) || right.aliases(target);
+    }
+
+    template <typename E, bool Divide>
+    Scaled<E, Divide>::Scaled(const E &obj, const value_type &scalar) : expression(obj), value(scalar)
+    {
+        typedef typename std::decay<decltype(std::abs(scalar))>::type magnitude_type;
+        if (Divide && std::abs(value) < std::numeric_limits<magnitude_type>::epsilon())
+        {
+            throw std::overflow_error("Division by zero");
+        }
+    }
+
+    template <typename E, bool Divide>
+    typename Scaled<E, Divide>::size_type Scaled<E, Divide>::size1() const
+    {
+        return expression.size1();
+    }
+
+    template <typename E, bool Divide>
+    typename Scaled<E, Divide>::size_type Scaled<E, Divide>::size2() const
+    {
+        return expression.size2();
+    }
+
+    template <typename E, bool Divide>
+    typename Scaled<E, Divide>::value_type Scaled<E, Divide>::element(const size_type i, const size_type j) const
+    {
+        return Divide ? expression.element(i, j) / value : expression.element(i, j) * value;
+    }
+
+    template <typename E, bool Divide>
+    template <typename D>
+    void Scaled<E, Divide>::accumulate(D &target, const value_type &alpha) const
+    {
+        expression.accumulate(target, Divide ? alpha / value : alpha * value);
+    }
+
+    template <typename E, bool Divide>
+    template <typename D>
+    bool Scaled<E, Divide>::references(const D &target) const
+    {
+        return expression.references(target);
+    }
+
+    template <typename E, bool Divide>
+    template <typename D>
+    bool Scaled<E, Divide>::aliases(const D &target) const
+    {
+        return expression.aliases(target);
+    }
+
+    template <typename E>
+    Negation<E>::Negation(const E &obj) : expression(obj)
+    {
+    }
+
+    template <typename E>
+    typename Negation<E>::size_type Negation<E>::size1() const
+    {
+        return expression.size1();
+    }
+
+    template <typename E>
+    typename Negation<E>::size_type Negation<E>::size2() const
+    {
+        return expression.size2();
+    }
+
+    template <typename E>
+    typename Negation<E>::value_type Negation<E>::element(const size_type i, const size_type j) const
+    {
+        return -expression.element(i, j);
+    }
+
+    template <typename E>
+    template <typename D>
+    void Negation<E>::accumulate(D &target, const value_type &alpha) const
+    {
+        expression.accumulate(target, -alpha);
+    }
+
+    template <typename E>
+    template <typename D>
+    bool Negation<E>::references(const D &target) const
+    {
+        return expression.references(target);
+    }
+
+    template <typename E>
+    template <typename D>
+    bool Negation<E>::aliases(const D &target) const
+    {
+        return expression.aliases(target);
+    }
+
+    template <typename L, typename R>
+    Product<L, R>::Product(const L &lhs, const R &rhs) : left(lhs), right(rhs)
+    {
+        if (left.size2() != right.size1())
+        {
+            throw std::domain_error("Matrices can't be multiplied");
+        }
+    }
+
+    template <typename L, typename R>
+    typename Product<L, R>::size_type Product<L, R>::size1() const
+    {
+        return left.size1();
+    }
+
+    template <typename L, typename R>
+    typename Product<L, R>::size_type Product<L, R>::size2() const
+    {
+        return right.size2();
+    }
+
+    template <typename L, typename R>
+    typename Product<L, R>::value_type Product<L, R>::element(const size_type, const size_type) const
+    {
+        return value_type();
+    }
+
+    template <typename L, typename R>
+    template <typename D>
+    void Product<L, R>::accumulate(D &target, const value_type &alpha) const
+    {
+        matrix_type left_storage, right_storage;
+        const ConstMatrixView<value_type> a = materialize(left, left_storage), b = materialize(right, right_storage);
+        matrix_kernels::gemm(a.size1(), b.size2(), a.size2(), alpha,
+            a.data(), a.stride(), 1, b.data(), b.stride(), 1, target.data(), target.stride());
+    }
+
+    // A lone product overwrites the destination, which lets it use Strassen.
+    template <typename L, typename R>
+    template <typename D>
+    void Product<L, R>::assign(D &target) const
+    {
+        matrix_type left_storage, right_storage;
+        const ConstMatrixView<value_type> a = materialize(left, left_storage), b = materialize(right, right_storage);
+        matrix_kernels::multiply(a.size1(), b.size2(), a.size2(),
+            a.data(), a.stride(), b.data(), b.stride(), target.data(), target.stride());
+    }
+
+    template <typename L, typename R>
+    template <typename D>
+    bool Product<L, R>::references(const D &target) const
+    {
+        return left.references(target) || right.references(target);
+    }
+
+    // gemm writes the destination while it still reads the operands.
+    template <typename L, typename R>
+    template <typename D>
+    bool Product<L, R>::aliases(const D &target) const
+    {
+        return references(target);
+    }
+
+    // Whether the storage of two operands, from data() to the last element
+    // of the last row, intersects.
+    template <typename M, typename N>
+    bool overlaps(const M &x, const N &y)
+    {
+        if (!x.size1() || !x.size2() || !y.size1() || !y.size2())
+        {
+            return false;
+        }
+
+        const std::less<const void *> before;
+        const void *const x_last = x.data() + (x.size1() - 1u) * x.stride() + x.size2();
+        const void *const y_last = y.data() + (y.size1() - 1u) * y.stride() + y.size2();
+        return before(x.data(), y_last) && before(y.data(), x_last);
+    }
+
+    // Matrices and views are multiplied in place, other operands are
+    // evaluated into storage first.
+    template <typename M, typename S>
+    ConstMatrixView<typename M::value_type> materialize(const Leaf<M> &obj, S &)
+    {
+        const M &matrix = obj.get();
+        return ConstMatrixView<typename M::value_type>(matrix.data(), matrix.size1(), matrix.size2(), matrix.stride());
+    }
+
+    template <typename E, typename S>
+    ConstMatrixView<typename E::value_type> materialize(const E &obj, S &storage)
+    {
+        storage = obj;
+        return ConstMatrixView<typename E::value_type>(storage.data(), storage.size1(), storage.size2(), storage.stride());
+    }
+
+    // target already has the shape of obj and obj does not alias it.
+    template <typename D, typename E>
+    void assign(D &target, const E &obj)
+    {
+        const typename D::size_type m = target.size1(), n = target.size2(), stride = target.stride();
+        for (typename D::size_type i = 0u; i < m; ++i)
+        {
+            typename D::pointer const row = target.data() + i * stride;
+            for (typename D::size_type j = 0u; j < n; ++j)
+            {
+                row[j] = obj.element(i, j);
+            }
+        }
+        obj.accumulate(target, typename D::value_type(1));
+    }
+
+    template <typename D, typename L, typename R>
+    void assign(D &target, const Product<L, R> &obj)
+    {
+        obj.assign(target);
+    }
+
+    template <typename D, typename E>
+    void add(D &target, const E &obj, const bool subtract)
+    {
+        const typename D::size_type m = target.size1(), n = target.size2(), stride = target.stride();
+        for (typename D::size_type i = 0u; i < m; ++i)
+        {
+            typename D::pointer const row = target.data() + i * stride;
+            if (subtract)
+            {
+                for (typename D::size_type j = 0u; j < n; ++j)
+                {
+                    row[j] -= obj.element(i, j);
+                }
+            }
+            else
+            {
+                for (typename D::size_type j = 0u; j < n; ++j)
+                {
+                    row[j] += obj.element(i, j);
+                }
+            }
+        }
+        obj.accumulate(target, typename D::value_type(subtract ? -1 : 1));
+    }
+}
+
+template <typename L, typename R>
+typename std::enable_if<matrix_expressions::is_expression<L>::value && matrix_expressions::is_expression<R>::value,
+    matrix_expressions::Sum<L, R, false>>::type operator +(const L &lhs, const R &rhs)
+{
+    return matrix_expressions::Sum<L, R, false>(lhs, rhs);
+}
+
+template <typename L, typename R>
+typename std::enable_if<matrix_expressions::is_expression<L>::value && matrix_expressions::is_expression<R>::value,
+    matrix_expressions::Sum<L, R, true>>::type operator -(const L &lhs, const R &rhs)
+{
+    return matrix_expressions::Sum<L, R, true>(lhs, rhs);
+}
+
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value,
+    matrix_expressions::Negation<E>>::type operator -(const E &obj)
+{
+    return matrix_expressions::Negation<E>(obj);
+}
+
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value,
+    matrix_expressions::Scaled<E, false>>::type operator *(const E &lhs, const typename E::value_type &value)
+{
+    return matrix_expressions::Scaled<E, false>(lhs, value);
+}
+
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value,
+    matrix_expressions::Scaled<E, false>>::type operator *(const typename E::value_type &value, const E &rhs)
+{
+    return matrix_expressions::Scaled<E, false>(rhs, value);
+}
+
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value,
+    matrix_expressions::Scaled<E, true>>::type operator /(const E &lhs, const typename E::value_type &value)
+{
+    return matrix_expressions::Scaled<E, true>(lhs, value);
+}
+
+template <typename L, typename R>
+typename std::enable_if<matrix_expressions::is_expression<L>::value && matrix_expressions::is_expression<R>::value,
+    matrix_expressions::Product<L, R>>::type operator *(const L &lhs, const R &rhs)
+{
+    return matrix_expressions::Product<L, R>(lhs, rhs);
+}
+
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value && !std::is_same<E, Matrix<typename E::value_type>>::value,
+    std::ostream &>::type operator <<(std::ostream &os, const E &obj)
+{
+    return os << Matrix<typename E::value_type>(obj);
+}
+
+#endif
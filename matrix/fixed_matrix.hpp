@@ -0,0 +1,351 @@
+#ifndef __FIXED_MATRIX_HPP__
+#define __FIXED_MATRIX_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "./matrix_view.hpp"
+
+// Matrix<T, R, C>: an R x C matrix whose elements are stored inline, row-major,
+// with no heap allocation. Every operation is constexpr and expands over the
+// elements through index sequences, so a 3 x 3 product is nine unrolled dot
+// products, and operands of the wrong dimensions do not compile. Converting
+// to Matrix<T> and back copies; view() lets a fixed matrix take part in the
+// lazy expressions of the dynamic one.
+template <typename T, std::size_t R, std::size_t C>
+class Matrix
+{
+    static_assert(R != dynamic_size && C != dynamic_size, "Matrix dimensions are either both fixed or both dynamic");
+    static_assert(R > 0u && C > 0u, "Matrix dimensions must be positive");
+
+public:
+    typedef typename std::enable_if<std::is_floating_point<T>::value, T>::type floating_point;
+    typedef floating_point value_type;
+    typedef value_type &reference;
+    typedef const value_type &const_reference;
+    typedef value_type *pointer;
+    typedef const value_type *const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Matrix<T> dynamic_type;
+
+    static constexpr const floating_point value_epsilon = std::numeric_limits<floating_point>::epsilon();
+
+private:
+    value_type cells[R * C];
+
+    template <std::size_t... I>
+    static constexpr Matrix identity(std::index_sequence<I...>);
+
+public:
+    constexpr Matrix();
+    template <typename... A, typename = typename std::enable_if<sizeof...(A) == R * C &&
+        std::is_same<std::integer_sequence<bool, true, std::is_convertible<A, value_type>::value...>,
+            std::integer_sequence<bool, std::is_convertible<A, value_type>::value..., true>>::value>::type>
+    constexpr explicit Matrix(const A &...);
+    explicit Matrix(const dynamic_type &);
+
+    static constexpr Matrix identity();
+
+    static constexpr size_type size1();
+    static constexpr size_type size2();
+    static constexpr size_type stride();
+    constexpr reference operator ()(size_type, size_type);
+    constexpr const_reference operator ()(size_type, size_type) const;
+    constexpr pointer data();
+    constexpr const_pointer data() const;
+
+    MatrixView<value_type> view();
+    ConstMatrixView<value_type> view() const;
+    operator dynamic_type() const;
+
+    constexpr Matrix &operator +=(const Matrix &);
+    constexpr Matrix &operator -=(const Matrix &);
+    constexpr Matrix &operator *=(const value_type &);
+    constexpr Matrix &operator /=(const value_type &);
+    constexpr Matrix &operator *=(const Matrix<T, C, C> &);
+};
+
+namespace matrix_fixed
+{
+    // Return type of the operations on fixed matrices; keeps them out of
+    // overload resolution for Matrix<T>.
+    template <std::size_t R, std::size_t C, typename Type>
+    using enable_if_fixed = typename std::enable_if<R != dynamic_size && C != dynamic_size, Type>::type;
+
+    template <typename T>
+    constexpr T sum(const T &x)
+    {
+        return x;
+    }
+
+    template <typename T, typename... A>
+    constexpr T sum(const T &x, const A &... rest)
+    {
+        return x + sum(rest...);
+    }
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t... I>
+    constexpr Matrix<T, R, C> negate(const Matrix<T, R, C> &obj, std::index_sequence<I...>)
+    {
+        return Matrix<T, R, C>(-obj.data()[I]...);
+    }
+
+    template <bool Subtract, typename T, std::size_t R, std::size_t C, std::size_t... I>
+    constexpr Matrix<T, R, C> add(const Matrix<T, R, C> &lhs, const Matrix<T, R, C> &rhs, std::index_sequence<I...>)
+    {
+        return Matrix<T, R, C>((Subtract ? lhs.data()[I] - rhs.data()[I] : lhs.data()[I] + rhs.data()[I])...);
+    }
+
+    template <bool Divide, typename T, std::size_t R, std::size_t C, std::size_t... I>
+    constexpr Matrix<T, R, C> scale(const Matrix<T, R, C> &obj, const T &value, std::index_sequence<I...>)
+    {
+        return Matrix<T, R, C>((Divide ? obj.data()[I] / value : obj.data()[I] * value)...);
+    }
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K, std::size_t... P>
+    constexpr T dot(const Matrix<T, R, C> &lhs, const Matrix<T, C, K> &rhs, const std::size_t i, const std::size_t j,
+        std::index_sequence<P...>)
+    {
+        return sum((lhs.data()[i * C + P] * rhs.data()[P * K + j])...);
+    }
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K, std::size_t... I>
+    constexpr Matrix<T, R, K> multiply(const Matrix<T, R, C> &lhs, const Matrix<T, C, K> &rhs, std::index_sequence<I...>)
+    {
+        return Matrix<T, R, K>(dot(lhs, rhs, I / K, I % K, std::make_index_sequence<C>())...);
+    }
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t... I>
+    constexpr Matrix<T, C, R> transpose(const Matrix<T, R, C> &obj, std::index_sequence<I...>)
+    {
+        return Matrix<T, C, R>(obj.data()[I % R * C + I / R]...);
+    }
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr const typename Matrix<T, R, C>::floating_point Matrix<T, R, C>::value_epsilon;
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C>::Matrix() : cells()
+{
+}
+
+template <typename T, std::size_t R, std::size_t C>
+template <typename... A, typename>
+constexpr Matrix<T, R, C>::Matrix(const A &... values) : cells{value_type(values)...}
+{
+}
+
+template <typename T, std::size_t R, std::size_t C>
+Matrix<T, R, C>::Matrix(const dynamic_type &obj) : cells()
+{
+    if (obj.size1() != R || obj.size2() != C)
+    {
+        throw std::domain_error("Matrices can't be assigned");
+    }
+    for (size_type i = 0u; i < R; ++i)
+    {
+        std::copy_n(obj.data() + i * obj.stride(), C, cells + i * C);
+    }
+}
+
+template <typename T, std::size_t R, std::size_t C>
+template <std::size_t... I>
+constexpr Matrix<T, R, C> Matrix<T, R, C>::identity(std::index_sequence<I...>)
+{
+    return Matrix(value_type(I / C == I % C ? 1 : 0)...);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> Matrix<T, R, C>::identity()
+{
+    static_assert(R == C, "Matrix isn't square");
+    return identity(std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::size_type Matrix<T, R, C>::size1()
+{
+    return R;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::size_type Matrix<T, R, C>::size2()
+{
+    return C;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::size_type Matrix<T, R, C>::stride()
+{
+    return C;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::reference Matrix<T, R, C>::operator ()(const size_type i, const size_type j)
+{
+    return cells[i * C + j];
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::const_reference Matrix<T, R, C>::operator ()(const size_type i, const size_type j) const
+{
+    return cells[i * C + j];
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::pointer Matrix<T, R, C>::data()
+{
+    return cells;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr typename Matrix<T, R, C>::const_pointer Matrix<T, R, C>::data() const
+{
+    return cells;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+MatrixView<typename Matrix<T, R, C>::value_type> Matrix<T, R, C>::view()
+{
+    return MatrixView<value_type>(cells, R, C, C);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+ConstMatrixView<typename Matrix<T, R, C>::value_type> Matrix<T, R, C>::view() const
+{
+    return ConstMatrixView<value_type>(cells, R, C, C);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+Matrix<T, R, C>::operator dynamic_type() const
+{
+    dynamic_type result(R, C);
+    for (size_type i = 0u; i < R; ++i)
+    {
+        std::copy_n(cells + i * C, C, result.data() + i * result.stride());
+    }
+
+    return result;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> &Matrix<T, R, C>::operator +=(const Matrix<T, R, C> &rhs)
+{
+    return *this = matrix_fixed::add<false>(*this, rhs, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> &Matrix<T, R, C>::operator -=(const Matrix<T, R, C> &rhs)
+{
+    return *this = matrix_fixed::add<true>(*this, rhs, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> &Matrix<T, R, C>::operator *=(const value_type &value)
+{
+    return *this = matrix_fixed::scale<false>(*this, value, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> &Matrix<T, R, C>::operator /=(const value_type &value)
+{
+    if (value < value_epsilon && -value < value_epsilon)
+    {
+        throw std::overflow_error("Division by zero");
+    }
+
+    return *this = matrix_fixed::scale<true>(*this, value, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr Matrix<T, R, C> &Matrix<T, R, C>::operator *=(const Matrix<T, C, C> &rhs)
+{
+    return *this = matrix_fixed::multiply(*this, rhs, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator +(const Matrix<T, R, C> &obj)
+{
+    return obj;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator -(const Matrix<T, R, C> &obj)
+{
+    return matrix_fixed::negate(obj, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator +(const Matrix<T, R, C> &lhs,
+    const Matrix<T, R, C> &rhs)
+{
+    return matrix_fixed::add<false>(lhs, rhs, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator -(const Matrix<T, R, C> &lhs,
+    const Matrix<T, R, C> &rhs)
+{
+    return matrix_fixed::add<true>(lhs, rhs, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator *(const Matrix<T, R, C> &lhs,
+    const typename Matrix<T, R, C>::value_type &value)
+{
+    return matrix_fixed::scale<false>(lhs, value, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator *(const typename Matrix<T, R, C>::value_type &value,
+    const Matrix<T, R, C> &rhs)
+{
+    return matrix_fixed::scale<false>(rhs, value, std::make_index_sequence<R * C>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, R, C>> operator /(const Matrix<T, R, C> &lhs,
+    const typename Matrix<T, R, C>::value_type &value)
+{
+    Matrix<T, R, C> result(lhs);
+    return result /= value;
+}
+
+template <typename T, std::size_t R, std::size_t C, std::size_t K>
+constexpr matrix_fixed::enable_if_fixed<R, K, Matrix<T, R, K>> operator *(const Matrix<T, R, C> &lhs,
+    const Matrix<T, C, K> &rhs)
+{
+    return matrix_fixed::multiply(lhs, rhs, std::make_index_sequence<R * K>());
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr matrix_fixed::enable_if_fixed<R, C, Matrix<T, C, R>> transpose(const Matrix<T, R, C> &obj)
+{
+    return matrix_fixed::transpose(obj, std::make_index_sequence<R * C>());
+}
+
+// Same format as Matrix<T>.
+template <typename T, std::size_t R, std::size_t C>
+matrix_fixed::enable_if_fixed<R, C, std::ostream &> operator <<(std::ostream &os, const Matrix<T, R, C> &m)
+{
+    os << R << ' ' << C << '\n';
+    for (std::size_t i = 0u; i < R; ++i)
+    {
+        for (std::size_t j = 0u; j < C; ++j)
+        {
+            os << m(i, j) << ' ';
+        }
+        os << '\n';
+    }
+
+    return os;
+}
+
+#endif
@@ -0,0 +1,405 @@
+#ifndef __GEMM_HPP__
+#define __GEMM_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./aligned_allocator.hpp"
+#include "./thread_pool.hpp"
+
+// op(A) and op(B) in the Matrix gemm(): the operand itself, its transpose or
+// its conjugate transpose.
+enum Transpose
+{
+    NO_TRANSPOSE,
+    TRANSPOSE,
+    CONJUGATE_TRANSPOSE
+};
+
+// GotoBLAS-style C += alpha * A * B. B is packed into kc x nc panels that
+// stay in L3, alpha * A into mc x kc blocks that stay in L2, and a
+// register-blocked micro-kernel multiplies one mr x kc sliver of A by one
+// kc x nr sliver of B from L1. Operands are addressed through a row and a
+// column stride, so transposes cost nothing, and either may be conjugated while
+// it is packed. C is row-major.
+namespace matrix_kernels
+{
+    constexpr const std::size_t L1_BYTES = 32768u;
+    constexpr const std::size_t L2_BYTES = 524288u;
+    constexpr const std::size_t L3_BYTES = 8388608u;
+
+    template <typename T>
+    struct Kernel
+    {
+        // C[mr x nr] (row stride ldc) += packed A sliver * packed B sliver.
+        typedef void (*function_type)(std::size_t, const T *, const T *, T *, std::size_t);
+
+        function_type function;
+        std::size_t mr;
+        std::size_t nr;
+        std::size_t kc;
+        std::size_t mc;
+        std::size_t nc;
+    };
+
+    template <typename T>
+    using Buffer = std::vector<T, AlignedAllocator<T>>;
+
+    template <typename T>
+    Kernel<T> make_kernel(typename Kernel<T>::function_type, std::size_t, std::size_t);
+
+    template <typename T, std::size_t MR, std::size_t NR>
+    void generic_kernel(std::size_t, const T *, const T *, T *, std::size_t);
+
+    template <typename T>
+    const Kernel<T> &kernel();
+
+    template <typename T>
+    T conjugate(const T &);
+    template <typename T>
+    std::complex<T> conjugate(const std::complex<T> &);
+
+    template <typename T>
+    void pack_a(std::size_t, std::size_t, const T &, const T *, std::ptrdiff_t, std::ptrdiff_t, bool, std::size_t, T *);
+    template <typename T>
+    void pack_b(std::size_t, std::size_t, const T *, std::ptrdiff_t, std::ptrdiff_t, bool, std::size_t, T *);
+    template <typename T>
+    void macro_kernel(const Kernel<T> &, std::size_t, std::size_t, std::size_t, const T *, const T *, T *, std::size_t, T *);
+
+    // The mutex guards threads and pool; cutoff is read by every product and
+    // may change while they run.
+    struct Parallelism
+    {
+        std::mutex mutex;
+        std::size_t threads;
+        std::atomic<std::size_t> cutoff;
+        std::unique_ptr<ThreadPool> pool;
+    };
+
+    Parallelism &parallelism();
+    std::size_t threads();
+    void set_threads(std::size_t);
+    std::size_t parallel_cutoff();
+    void set_parallel_cutoff(std::size_t);
+    ThreadPool *pool();
+
+    template <typename T>
+    T *scratch(std::size_t, std::size_t);
+    template <typename T>
+    void serial_gemm(const Kernel<T> &, std::size_t, std::size_t, std::size_t, const T &,
+        const T *, std::ptrdiff_t, std::ptrdiff_t, bool,
+        const T *, std::ptrdiff_t, std::ptrdiff_t, bool,
+        T *, std::size_t);
+    template <typename T>
+    void parallel_gemm(ThreadPool &, const Kernel<T> &, std::size_t, std::size_t, std::size_t, const T &,
+        const T *, std::ptrdiff_t, std::ptrdiff_t, bool,
+        const T *, std::ptrdiff_t, std::ptrdiff_t, bool,
+        T *, std::size_t);
+    template <typename T>
+    void gemm(std::size_t, std::size_t, std::size_t, const T &,
+        const T *, std::ptrdiff_t, std::ptrdiff_t,
+        const T *, std::ptrdiff_t, std::ptrdiff_t,
+        T *, std::size_t, bool = false, bool = false);
+
+    template <typename T>
+    Kernel<T> make_kernel(const typename Kernel<T>::function_type function, const std::size_t mr, const std::size_t nr)
+    {
+        // A kc x nr sliver of B fills half of L1, an mc x kc block of A half
+        // of L2 and a kc x nc panel of B half of L3.
+        const std::size_t kc = std::max<std::size_t>(L1_BYTES / 2u / (nr * sizeof(T)) / 8u * 8u, 16u);
+        const std::size_t mc = std::max<std::size_t>(L2_BYTES / 2u / (kc * sizeof(T)) / mr * mr, mr);
+        const std::size_t nc = std::max<std::size_t>(L3_BYTES / 2u / (kc * sizeof(T)) / nr * nr, nr);
+
+        return Kernel<T>{function, mr, nr, kc, mc, nc};
+    }
+
+    template <typename T, std::size_t MR, std::size_t NR>
+    void generic_kernel(const std::size_t kc, const T *a, const T *b, T *const c, const std::size_t ldc)
+    {
+        T ab[MR * NR] = {};
+        for (std::size_t p = 0u; p < kc; ++p, a += MR, b += NR)
+        {
+            for (std::size_t i = 0u; i < MR; ++i)
+            {
+                for (std::size_t j = 0u; j < NR; ++j)
+                {
+                    ab[i * NR + j] += a[i] * b[j];
+                }
+            }
+        }
+        for (std::size_t i = 0u; i < MR; ++i)
+        {
+            for (std::size_t j = 0u; j < NR; ++j)
+            {
+                c[i * ldc + j] += ab[i * NR + j];
+            }
+        }
+    }
+
+    template <typename T>
+    const Kernel<T> &kernel()
+    {
+        static const Kernel<T> instance(make_kernel<T>(&generic_kernel<T, 4u, 4u>, 4u, 4u));
+        return instance;
+    }
+
+    template <typename T>
+    T conjugate(const T &value)
+    {
+        return value;
+    }
+
+    template <typename T>
+    std::complex<T> conjugate(const std::complex<T> &value)
+    {
+        return std::conj(value);
+    }
+
+    // Slivers of mr rows of alpha * A, or of alpha * conj(A), each stored
+    // column by column; the last sliver is padded with zeros.
+    template <typename T>
+    void pack_a(const std::size_t mc, const std::size_t kc, const T &alpha, const T *const a,
+        const std::ptrdiff_t rs, const std::ptrdiff_t cs, const bool conjugated, const std::size_t mr, T *buffer)
+    {
+        for (std::size_t i = 0u; i < mc; i += mr)
+        {
+            const std::size_t rows = std::min(mr, mc - i);
+            for (std::size_t p = 0u; p < kc; ++p, buffer += mr)
+            {
+                const T *const column = a + std::ptrdiff_t(i) * rs + std::ptrdiff_t(p) * cs;
+                for (std::size_t r = 0u; r < rows; ++r)
+                {
+                    const T &value = column[std::ptrdiff_t(r) * rs];
+                    buffer[r] = alpha * (conjugated ? conjugate(value) : value);
+                }
+                std::fill(buffer + rows, buffer + mr, T());
+            }
+        }
+    }
+
+    // Slivers of nr columns of B, or of conj(B), each stored row by row; the last sliver is
+    // padded with zeros.
+    template <typename T>
+    void pack_b(const std::size_t kc, const std::size_t nc, const T *const b,
+        const std::ptrdiff_t rs, const std::ptrdiff_t cs, const bool conjugated, const std::size_t nr, T *buffer)
+    {
+        for (std::size_t j = 0u; j < nc; j += nr)
+        {
+            const std::size_t columns = std::min(nr, nc - j);
+            for (std::size_t p = 0u; p < kc; ++p, buffer += nr)
+            {
+                const T *const row = b + std::ptrdiff_t(p) * rs + std::ptrdiff_t(j) * cs;
+                for (std::size_t s = 0u; s < columns; ++s)
+                {
+                    const T &value = row[std::ptrdiff_t(s) * cs];
+                    buffer[s] = conjugated ? conjugate(value) : value;
+                }
+                std::fill(buffer + columns, buffer + nr, T());
+            }
+        }
+    }
+
+    // Edge tiles are computed into the mr x nr scratch tile and then added.
+    template <typename T>
+    void macro_kernel(const Kernel<T> &k, const std::size_t mc, const std::size_t nc, const std::size_t kc,
+        const T *const a, const T *const b, T *const c, const std::size_t ldc, T *const tile)
+    {
+        for (std::size_t j = 0u; j < nc; j += k.nr)
+        {
+            const std::size_t columns = std::min(k.nr, nc - j);
+            const T *const sliver_b = b + j * kc;
+            for (std::size_t i = 0u; i < mc; i += k.mr)
+            {
+                const std::size_t rows = std::min(k.mr, mc - i);
+                const T *const sliver_a = a + i * kc;
+                T *const target = c + i * ldc + j;
+                if (rows == k.mr && columns == k.nr)
+                {
+                    k.function(kc, sliver_a, sliver_b, target, ldc);
+                }
+                else
+                {
+                    std::fill(tile, tile + k.mr * k.nr, T());
+                    k.function(kc, sliver_a, sliver_b, tile, k.nr);
+                    for (std::size_t r = 0u; r < rows; ++r)
+                    {
+                        for (std::size_t s = 0u; s < columns; ++s)
+                        {
+                            target[r * ldc + s] += tile[r * k.nr + s];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    inline Parallelism &parallelism()
+    {
+        static Parallelism instance{{}, std::max(std::thread::hardware_concurrency(), 1u), {std::size_t(1u) << 21u}, nullptr};
+        return instance;
+    }
+
+    inline std::size_t threads()
+    {
+        Parallelism &state = parallelism();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.threads;
+    }
+
+    // Takes effect for the next multiplication; none may be running.
+    inline void set_threads(const std::size_t count)
+    {
+        Parallelism &state = parallelism();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.threads = std::max<std::size_t>(count, 1u);
+        state.pool.reset();
+    }
+
+    inline std::size_t parallel_cutoff()
+    {
+        return parallelism().cutoff.load(std::memory_order_relaxed);
+    }
+
+    inline void set_parallel_cutoff(const std::size_t multiply_adds)
+    {
+        parallelism().cutoff.store(multiply_adds, std::memory_order_relaxed);
+    }
+
+    inline ThreadPool *pool()
+    {
+        Parallelism &state = parallelism();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.threads > 1u && !state.pool)
+        {
+            state.pool.reset(new ThreadPool(state.threads - 1u));
+        }
+
+        return state.pool.get();
+    }
+
+    template <typename T>
+    T *scratch(const std::size_t slot, const std::size_t size)
+    {
+        thread_local Buffer<T> buffers[2];
+        if (buffers[slot].size() < size)
+        {
+            buffers[slot].resize(size);
+        }
+
+        return buffers[slot].data();
+    }
+
+    template <typename T>
+    void serial_gemm(const Kernel<T> &k, const std::size_t m, const std::size_t n, const std::size_t l, const T &alpha,
+        const T *const a, const std::ptrdiff_t rsa, const std::ptrdiff_t csa, const bool conjugate_a,
+        const T *const b, const std::ptrdiff_t rsb, const std::ptrdiff_t csb, const bool conjugate_b,
+        T *const c, const std::size_t ldc)
+    {
+        const std::size_t kc = std::min(k.kc, l);
+        const std::size_t mc = std::min(k.mc, (m + k.mr - 1u) / k.mr * k.mr);
+        const std::size_t nc = std::min(k.nc, (n + k.nr - 1u) / k.nr * k.nr);
+        Buffer<T> packed_a(mc * kc), packed_b(kc * nc), tile(k.mr * k.nr);
+
+        for (std::size_t jc = 0u; jc < n; jc += k.nc)
+        {
+            const std::size_t nb = std::min(k.nc, n - jc);
+            for (std::size_t pc = 0u; pc < l; pc += k.kc)
+            {
+                const std::size_t kb = std::min(k.kc, l - pc);
+                pack_b(kb, nb, b + std::ptrdiff_t(pc) * rsb + std::ptrdiff_t(jc) * csb, rsb, csb, conjugate_b, k.nr, packed_b.data());
+                for (std::size_t ic = 0u; ic < m; ic += k.mc)
+                {
+                    const std::size_t mb = std::min(k.mc, m - ic);
+                    pack_a(mb, kb, alpha, a + std::ptrdiff_t(ic) * rsa + std::ptrdiff_t(pc) * csa, rsa, csa, conjugate_a, k.mr, packed_a.data());
+                    macro_kernel(k, mb, nb, kb, packed_a.data(), packed_b.data(), c + ic * ldc + jc, ldc, tile.data());
+                }
+            }
+        }
+    }
+
+    // Every kc x nc panel of B is packed once, cooperatively, and shared by
+    // all threads. The output is then cut into row blocks of at most mc rows,
+    // and into column ranges of whole slivers when there are fewer blocks
+    // than threads; each task packs its own block of A into thread-local
+    // scratch and runs the macro-kernel on its tile.
+    template <typename T>
+    void parallel_gemm(ThreadPool &workers, const Kernel<T> &k, const std::size_t m, const std::size_t n, const std::size_t l, const T &alpha,
+        const T *const a, const std::ptrdiff_t rsa, const std::ptrdiff_t csa, const bool conjugate_a,
+        const T *const b, const std::ptrdiff_t rsb, const std::ptrdiff_t csb, const bool conjugate_b,
+        T *const c, const std::size_t ldc)
+    {
+        const std::size_t count = workers.size() + 1u;
+        const std::size_t nc = std::min(k.nc, (n + k.nr - 1u) / k.nr * k.nr);
+        const std::size_t mc = std::min(k.mc, ((m + count - 1u) / count + k.mr - 1u) / k.mr * k.mr);
+        const std::size_t blocks = (m + mc - 1u) / mc;
+        Buffer<T> packed_b(std::min(k.kc, l) * nc);
+
+        for (std::size_t jc = 0u; jc < n; jc += k.nc)
+        {
+            const std::size_t nb = std::min(k.nc, n - jc);
+            const std::size_t slivers = (nb + k.nr - 1u) / k.nr;
+            const std::size_t pack_parts = std::min(slivers, count);
+            const std::size_t column_parts = std::min(slivers, (count + blocks - 1u) / blocks);
+            for (std::size_t pc = 0u; pc < l; pc += k.kc)
+            {
+                const std::size_t kb = std::min(k.kc, l - pc);
+                const T *const panel = b + std::ptrdiff_t(pc) * rsb + std::ptrdiff_t(jc) * csb;
+                workers.run(pack_parts, [&](const std::size_t part)
+                {
+                    const std::size_t first = slivers * part / pack_parts * k.nr;
+                    const std::size_t last = std::min(nb, slivers * (part + 1u) / pack_parts * k.nr);
+                    pack_b(kb, last - first, panel + std::ptrdiff_t(first) * csb, rsb, csb, conjugate_b, k.nr, packed_b.data() + first * kb);
+                });
+                workers.run(blocks * column_parts, [&](const std::size_t task)
+                {
+                    const std::size_t ic = task / column_parts * mc, part = task % column_parts;
+                    const std::size_t mb = std::min(mc, m - ic);
+                    const std::size_t first = slivers * part / column_parts * k.nr;
+                    const std::size_t last = std::min(nb, slivers * (part + 1u) / column_parts * k.nr);
+                    T *const packed_a = scratch<T>(0u, mc * kb);
+                    pack_a(mb, kb, alpha, a + std::ptrdiff_t(ic) * rsa + std::ptrdiff_t(pc) * csa, rsa, csa, conjugate_a, k.mr, packed_a);
+                    macro_kernel(k, mb, last - first, kb, packed_a, packed_b.data() + first * kb,
+                        c + ic * ldc + jc + first, ldc, scratch<T>(1u, k.mr * k.nr));
+                });
+            }
+        }
+    }
+
+    // C[m x n] += alpha * A[m x l] * B[l x n], where A(i, p) is
+    // a[i * rsa + p * csa], B(p, j) is b[p * rsb + j * csb] and C(i, j) is
+    // c[i * ldc + j]; conjugate_a and conjugate_b replace A and B by their
+    // conjugates. Products of at least parallel_cutoff() multiply-adds run on
+    // threads() threads.
+    template <typename T>
+    void gemm(const std::size_t m, const std::size_t n, const std::size_t l, const T &alpha,
+        const T *const a, const std::ptrdiff_t rsa, const std::ptrdiff_t csa,
+        const T *const b, const std::ptrdiff_t rsb, const std::ptrdiff_t csb,
+        T *const c, const std::size_t ldc, const bool conjugate_a, const bool conjugate_b)
+    {
+        if (!m || !n || !l)
+        {
+            return;
+        }
+
+        const Kernel<T> &k = kernel<T>();
+        ThreadPool *const workers = double(m) * double(n) * double(l) >= double(parallel_cutoff()) ? pool() : nullptr;
+        if (workers)
+        {
+            parallel_gemm(*workers, k, m, n, l, alpha, a, rsa, csa, conjugate_a, b, rsb, csb, conjugate_b, c, ldc);
+        }
+        else
+        {
+            serial_gemm(k, m, n, l, alpha, a, rsa, csa, conjugate_a, b, rsb, csb, conjugate_b, c, ldc);
+        }
+    }
+}
+
+#include "./gemm_kernels.hpp"
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef __GEMM_KERNELS_HPP__
+#define __GEMM_KERNELS_HPP__
+
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATRIX_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// gemm.hpp includes this header at its end, after the generic kernel, Kernel
+// and make_kernel; including gemm.hpp here, once the guard above is set, gives
+// the same order when this header is included on its own.
+#include "./gemm.hpp"
+
+// Vectorised micro-kernels for float and double. Each one is compiled for its
+// own instruction set through a target attribute, so the rest of the program
+// keeps the baseline flags and one binary runs on every x86-64 CPU;
+// kernel<float>() and kernel<double>() pick the widest one the CPU supports.
+// The accumulators are mr x (nr / width) vector registers, B slivers are
+// loaded a row at a time and A elements are broadcast.
+namespace matrix_kernels
+{
+#ifdef MATRIX_X86_KERNELS
+    namespace haswell
+    {
+        template <typename T>
+        struct Shape;
+
+        template <>
+        struct Shape<double>
+        {
+            static constexpr const std::size_t mr = 6u;
+            static constexpr const std::size_t nr = 8u;
+        };
+
+        template <>
+        struct Shape<float>
+        {
+            static constexpr const std::size_t mr = 6u;
+            static constexpr const std::size_t nr = 16u;
+        };
+
+        __attribute__((target("avx2,fma")))
+        inline void kernel(const std::size_t kc, const double *a, const double *b, double *const c, const std::size_t ldc)
+        {
+            __m256d ab[Shape<double>::mr][2];
+            for (std::size_t i = 0u; i < Shape<double>::mr; ++i)
+            {
+                ab[i][0] = _mm256_setzero_pd();
+                ab[i][1] = _mm256_setzero_pd();
+            }
+            for (std::size_t p = 0u; p < kc; ++p, a += Shape<double>::mr, b += Shape<double>::nr)
+            {
+                const __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);
+                for (std::size_t i = 0u; i < Shape<double>::mr; ++i)
+                {
+                    const __m256d ai = _mm256_broadcast_sd(a + i);
+                    ab[i][0] = _mm256_fmadd_pd(ai, b0, ab[i][0]);
+                    ab[i][1] = _mm256_fmadd_pd(ai, b1, ab[i][1]);
+                }
+            }
+            for (std::size_t i = 0u; i < Shape<double>::mr; ++i)
+            {
+                double *const row = c + i * ldc;
+                _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), ab[i][0]));
+                _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), ab[i][1]));
+            }
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline void kernel(const std::size_t kc, const float *a, const float *b, float *const c, const std::size_t ldc)
+        {
+            __m256 ab[Shape<float>::mr][2];
+            for (std::size_t i = 0u; i < Shape<float>::mr; ++i)
+            {
+                ab[i][0] = _mm256_setzero_ps();
+                ab[i][1] = _mm256_setzero_ps();
+            }
+            for (std::size_t p = 0u; p < kc; ++p, a += Shape<float>::mr, b += Shape<float>::nr)
+            {
+                const __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+                for (std::size_t i = 0u; i < Shape<float>::mr; ++i)
+                {
+                    const __m256 ai = _mm256_broadcast_ss(a + i);
+                    ab[i][0] = _mm256_fmadd_ps(ai, b0, ab[i][0]);
+                    ab[i][1] = _mm256_fmadd_ps(ai, b1, ab[i][1]);
+                }
+            }
+            for (std::size_t i = 0u; i < Shape<float>::mr; ++i)
+            {
+                float *const row = c + i * ldc;
+                _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), ab[i][0]));
+                _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), ab[i][1]));
+            }
+        }
+    }
+
+    namespace skylake_avx512
+    {
+        template <typename T>
+        struct Shape;
+
+        template <>
+        struct Shape<double>
+        {
+            static constexpr const std::size_t mr = 12u;
+            static constexpr const std::size_t nr = 16u;
+        };
+
+        template <>
+        struct Shape<float>
+        {
+            static constexpr const std::size_t mr = 12u;
+            static constexpr const std::size_t nr = 32u;
+        };
+
+        __attribute__((target("avx512f")))
+        inline void kernel(const std::size_t kc, const double *a, const double *b, double *const c, const std::size_t ldc)
+        {
+            __m512d ab[Shape<double>::mr][2];
+            for (std::size_t i = 0u; i < Shape<double>::mr; ++i)
+            {
+                ab[i][0] = _mm512_setzero_pd();
+                ab[i][1] = _mm512_setzero_pd();
+            }
+            for (std::size_t p = 0u; p < kc; ++p, a += Shape<double>::mr, b += Shape<double>::nr)
+            {
+                const __m512d b0 = _mm512_loadu_pd(b), b1 = _mm512_loadu_pd(b + 8);
+                for (std::size_t i = 0u; i < Shape<double>::mr; ++i)
+                {
+                    const __m512d ai = _mm512_set1_pd(a[i]);
+                    ab[i][0] = _mm512_fmadd_pd(ai, b0, ab[i][0]);
+                    ab[i][1] = _mm512_fmadd_pd(ai, b1, ab[i][1]);
+                }
+            }
+            for (std::size_t i = 0u; i < Shape<double>::mr; ++i)
+            {
+                double *const row = c + i * ldc;
+                _mm512_storeu_pd(row, _mm512_add_pd(_mm512_loadu_pd(row), ab[i][0]));
+                _mm512_storeu_pd(row + 8, _mm512_add_pd(_mm512_loadu_pd(row + 8), ab[i][1]));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        inline void kernel(const std::size_t kc, const float *a, const float *b, float *const c, const std::size_t ldc)
+        {
+            __m512 ab[Shape<float>::mr][2];
+            for (std::size_t i = 0u; i < Shape<float>::mr; ++i)
+            {
+                ab[i][0] = _mm512_setzero_ps();
+                ab[i][1] = _mm512_setzero_ps();
+            }
+            for (std::size_t p = 0u; p < kc; ++p, a += Shape<float>::mr, b += Shape<float>::nr)
+            {
+                const __m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+                for (std::size_t i = 0u; i < Shape<float>::mr; ++i)
+                {
+                    const __m512 ai = _mm512_set1_ps(a[i]);
+                    ab[i][0] = _mm512_fmadd_ps(ai, b0, ab[i][0]);
+                    ab[i][1] = _mm512_fmadd_ps(ai, b1, ab[i][1]);
+                }
+            }
+            for (std::size_t i = 0u; i < Shape<float>::mr; ++i)
+            {
+                float *const row = c + i * ldc;
+                _mm512_storeu_ps(row, _mm512_add_ps(_mm512_loadu_ps(row), ab[i][0]));
+                _mm512_storeu_ps(row + 16, _mm512_add_ps(_mm512_loadu_ps(row + 16), ab[i][1]));
+            }
+        }
+    }
+#endif
+
+    template <typename T>
+    Kernel<T> select_kernel()
+    {
+#ifdef MATRIX_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return make_kernel<T>(&skylake_avx512::kernel, skylake_avx512::Shape<T>::mr, skylake_avx512::Shape<T>::nr);
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return make_kernel<T>(&haswell::kernel, haswell::Shape<T>::mr, haswell::Shape<T>::nr);
+        }
+#endif
+        return make_kernel<T>(&generic_kernel<T, 4u, 4u>, 4u, 4u);
+    }
+
+    template <>
+    inline const Kernel<double> &kernel<double>()
+    {
+        static const Kernel<double> instance(select_kernel<double>());
+        return instance;
+    }
+
+    template <>
+    inline const Kernel<float> &kernel<float>()
+    {
+        static const Kernel<float> instance(select_kernel<float>());
+        return instance;
+    }
+}
+
+#endif
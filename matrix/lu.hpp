@@ -0,0 +1,256 @@
+#ifndef __LU_HPP__
+#define __LU_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "./matrix_complex.hpp"
+
+// P * A = L * U with partial pivoting, right-looking and blocked: a panel of
+// block_size columns is factored row by row, the matching rows of U are
+// solved against its unit lower triangle, and the trailing submatrix gets one
+// gemm update. L (unit diagonal, not stored) and U share one matrix; row i
+// was swapped with row pivots()[i] when column i was eliminated. An exactly
+// zero pivot marks the matrix singular; the factorization still completes,
+// the determinant is then zero and solve() and inverse() throw.
+template <typename T>
+class LU
+{
+public:
+    typedef Matrix<T> matrix_type;
+    typedef typename matrix_type::value_type value_type;
+    typedef typename matrix_type::size_type size_type;
+
+    static constexpr const size_type block_size = 64u;
+
+private:
+    matrix_type factors;
+    std::vector<size_type> swaps;
+    bool odd = false;
+    bool singular = false;
+
+    void factor_panel(size_type, size_type);
+
+public:
+    explicit LU(matrix_type);
+
+    const matrix_type &matrix() const;
+    const std::vector<size_type> &pivots() const;
+    bool is_singular() const;
+
+    value_type determinant() const;
+    matrix_type solve(const matrix_type &) const;
+    matrix_type inverse() const;
+};
+
+template <typename T>
+constexpr const typename LU<T>::size_type LU<T>::block_size;
+
+template <typename T>
+Matrix<T> solve(const Matrix<T> &, const Matrix<T> &);
+template <typename T>
+typename Matrix<T>::value_type determinant(const Matrix<T> &);
+template <typename T>
+Matrix<T> inverse(const Matrix<T> &);
+
+template <typename T>
+LU<T>::LU(matrix_type obj) : factors(std::move(obj)), swaps()
+{
+    const size_type n = factors.size1();
+    if (n != factors.size2())
+    {
+        throw std::domain_error("Matrix isn't square");
+    }
+
+    swaps.resize(n);
+    value_type *const a = factors.data();
+    const size_type lda = factors.stride();
+    for (size_type k = 0u; k < n; k += block_size)
+    {
+        const size_type b = std::min(block_size, n - k), rest = n - k - b;
+        factor_panel(k, b);
+
+        // U12 = L11^-1 * A12.
+        for (size_type i = k + 1u; i < k + b; ++i)
+        {
+            value_type *const target = a + i * lda + k + b;
+            for (size_type p = k; p < i; ++p)
+            {
+                const value_type l = a[i * lda + p];
+                const value_type *const source = a + p * lda + k + b;
+                for (size_type j = 0u; j < rest; ++j)
+                {
+                    target[j] -= l * source[j];
+                }
+            }
+        }
+
+        // A22 -= L21 * U12.
+        matrix_kernels::gemm(rest, rest, b, value_type(-1),
+            a + (k + b) * lda + k, lda, 1, a + k * lda + k + b, lda, 1, a + (k + b) * lda + k + b, lda);
+    }
+}
+
+// Columns k to k + b; pivoting swaps whole rows, so the columns of L already
+// computed and the trailing columns follow the permutation.
+template <typename T>
+void LU<T>::factor_panel(const size_type k, const size_type b)
+{
+    const size_type n = factors.size1(), lda = factors.stride();
+    value_type *const a = factors.data();
+    for (size_type j = k; j < k + b; ++j)
+    {
+        size_type p = j;
+        for (size_type i = j + 1u; i < n; ++i)
+        {
+            if (std::abs(a[i * lda + j]) > std::abs(a[p * lda + j]))
+            {
+                p = i;
+            }
+        }
+        swaps[j] = p;
+        if (p != j)
+        {
+            factors.row_switching(j, p);
+            odd = !odd;
+        }
+
+        const value_type pivot = a[j * lda + j];
+        if (pivot == value_type())
+        {
+            singular = true;
+            continue;
+        }
+
+        const value_type *const row = a + j * lda;
+        for (size_type i = j + 1u; i < n; ++i)
+        {
+            value_type *const target = a + i * lda;
+            const value_type l = target[j] /= pivot;
+            for (size_type c = j + 1u; c < k + b; ++c)
+            {
+                target[c] -= l * row[c];
+            }
+        }
+    }
+}
+
+template <typename T>
+const typename LU<T>::matrix_type &LU<T>::matrix() const
+{
+    return factors;
+}
+
+template <typename T>
+const std::vector<typename LU<T>::size_type> &LU<T>::pivots() const
+{
+    return swaps;
+}
+
+template <typename T>
+bool LU<T>::is_singular() const
+{
+    return singular;
+}
+
+template <typename T>
+typename LU<T>::value_type LU<T>::determinant() const
+{
+    value_type result(odd ? -1 : 1);
+    for (size_type i = 0u; i < factors.size1(); ++i)
+    {
+        result *= factors(i, i);
+    }
+
+    return result;
+}
+
+// X with A * X = B for every column of B, by forward and back substitution
+// in blocks of rows; each solved block updates the rest of X with one gemm.
+template <typename T>
+typename LU<T>::matrix_type LU<T>::solve(const matrix_type &rhs) const
+{
+    const size_type n = factors.size1();
+    if (rhs.size1() != n)
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+    if (singular)
+    {
+        throw std::domain_error("Matrix is singular");
+    }
+
+    matrix_type result(rhs);
+    for (size_type i = 0u; i < n; ++i)
+    {
+        result.row_switching(i, swaps[i]);
+    }
+
+    const size_type m = result.size2(), lda = factors.stride(), ldx = result.stride();
+    const value_type *const a = factors.data();
+    value_type *const x = result.data();
+    for (size_type k = 0u; k < n; k += block_size)
+    {
+        const size_type b = std::min(block_size, n - k);
+        for (size_type i = k + 1u; i < k + b; ++i)
+        {
+            for (size_type p = k; p < i; ++p)
+            {
+                result.row_addition(i, -a[i * lda + p], p);
+            }
+        }
+        matrix_kernels::gemm(n - k - b, m, b, value_type(-1),
+            a + (k + b) * lda + k, lda, 1, x + k * ldx, ldx, 1, x + (k + b) * ldx, ldx);
+    }
+
+    for (size_type end = n; end > 0u;)
+    {
+        const size_type k = (end - 1u) / block_size * block_size;
+        for (size_type i = end; i-- > k;)
+        {
+            for (size_type p = i + 1u; p < end; ++p)
+            {
+                result.row_addition(i, -a[i * lda + p], p);
+            }
+            result.row_multiplication(value_type(1) / a[i * lda + i], i);
+        }
+        matrix_kernels::gemm(k, m, end - k, value_type(-1),
+            a + k, lda, 1, x + k * ldx, ldx, 1, x, ldx);
+        end = k;
+    }
+
+    return result;
+}
+
+template <typename T>
+typename LU<T>::matrix_type LU<T>::inverse() const
+{
+    matrix_type identity;
+    identity.identity(factors.size1());
+
+    return solve(identity);
+}
+
+template <typename T>
+Matrix<T> solve(const Matrix<T> &lhs, const Matrix<T> &rhs)
+{
+    return LU<T>(lhs).solve(rhs);
+}
+
+template <typename T>
+typename Matrix<T>::value_type determinant(const Matrix<T> &obj)
+{
+    return LU<T>(obj).determinant();
+}
+
+template <typename T>
+Matrix<T> inverse(const Matrix<T> &obj)
+{
+    return LU<T>(obj).inverse();
+}
+
+#endif
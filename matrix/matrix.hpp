@@ -1,6 +1,7 @@
 #ifndef __MATRIX_HPP__
 #define __MATRIX_HPP__
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
@@ -8,21 +9,31 @@
 #include <vector>
 #include <type_traits>
 
+#include "./aligned_allocator.hpp"
+#include "./expression.hpp"
+#include "./fixed_matrix.hpp"
+#include "./matrix_view.hpp"
+#include "./transpose.hpp"
+
+// Elements live in one 64-byte-aligned row-major buffer; element (i, j) is at
+// data()[i * stride() + j].
 template <typename T>
-class Matrix
+class Matrix<T>
 {
 public:
     typedef typename std::enable_if<std::is_floating_point<T>::value, T>::type floating_point;
     typedef floating_point value_type;
 
 private:
-    typedef std::vector<value_type> row_type;
+    typedef std::vector<value_type, AlignedAllocator<value_type>> storage_type;
 
 public:
-    typedef typename row_type::reference reference;
-    typedef typename row_type::const_reference const_reference;
-    typedef typename row_type::size_type size_type;
-    typedef typename row_type::difference_type difference_type;
+    typedef typename storage_type::reference reference;
+    typedef typename storage_type::const_reference const_reference;
+    typedef typename storage_type::pointer pointer;
+    typedef typename storage_type::const_pointer const_pointer;
+    typedef typename storage_type::size_type size_type;
+    typedef typename storage_type::difference_type difference_type;
 
     static constexpr const floating_point value_epsilon = std::numeric_limits<floating_point>::epsilon();
     static constexpr const floating_point value_round_error = std::numeric_limits<floating_point>::round_error();
@@ -30,7 +41,9 @@ public:
     static constexpr const size_type size_max = std::numeric_limits<size_type>::max();
 
 private:
-    std::vector<row_type> matrix;
+    size_type rows = 0u;
+    size_type columns = 0u;
+    storage_type matrix;
 
 public:
     Matrix() = default;
@@ -42,11 +55,28 @@ public:
     Matrix &operator =(Matrix &&) = default;
     ~Matrix() = default;
 
+    template <typename E, typename = typename std::enable_if<matrix_expressions::is_expression<E>::value>::type>
+    Matrix(const E &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix &>::type operator =(const E &);
+
     size_type size1() const;
     size_type size2() const;
+    size_type stride() const;
     void resize(size_type, size_type);
     reference operator ()(size_type, size_type);
     const_reference operator ()(size_type, size_type) const;
+    pointer data();
+    const_pointer data() const;
+
+    MatrixView<value_type> submatrix(size_type, size_type, size_type, size_type);
+    ConstMatrixView<value_type> submatrix(size_type, size_type, size_type, size_type) const;
+    MatrixView<value_type> row(size_type);
+    ConstMatrixView<value_type> row(size_type) const;
+    MatrixView<value_type> column(size_type);
+    ConstMatrixView<value_type> column(size_type) const;
+    MatrixView<value_type> diagonal();
+    ConstMatrixView<value_type> diagonal() const;
 
     void zero(size_type, size_type);
     void identity(size_type);
@@ -60,27 +90,14 @@ public:
     void row_addition(size_type, value_type, size_type);
 
     Matrix operator +() const;
-    Matrix operator -() const;
 
-    template <typename S>
-    friend Matrix<S> operator *(const Matrix<S> &, const typename Matrix<S>::value_type &);
-    template <typename S>
-    friend Matrix<S> operator *(const typename Matrix<S>::value_type &, const Matrix<S> &);
     Matrix &operator *=(const value_type &);
-    template <typename S>
-    friend Matrix<S> operator /(const Matrix<S> &, const typename Matrix<S>::value_type &);
     Matrix &operator /=(const value_type &);
 
-    template <typename S>
-    friend Matrix<S> operator +(const Matrix<S> &, const Matrix<S> &);
-    Matrix &operator +=(const Matrix &);
-
-    template <typename S>
-    friend Matrix<S> operator -(const Matrix<S> &, const Matrix<S> &);
-    Matrix &operator -=(const Matrix &);
-
-    template <typename S>
-    friend Matrix<S> operator *(const Matrix<S> &, const Matrix<S> &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix &>::type operator +=(const E &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix &>::type operator -=(const E &);
     Matrix &operator *=(const Matrix &);
 
     template <typename S>
@@ -91,81 +108,188 @@ public:
 
 template <typename T>
 Matrix<T>::Matrix(const Matrix<T>::size_type row,
-    const Matrix<T>::size_type column) : matrix(row, row_type(column))
+    const Matrix<T>::size_type column) : rows(row), columns(column), matrix(row * column)
 {
 }
 
 template <typename T>
 Matrix<T>::Matrix(const Matrix<T>::size_type row,
     const Matrix<T>::size_type column,
-    const Matrix<T>::value_type &cell) : matrix(row, row_type(column, cell))
+    const Matrix<T>::value_type &cell) : rows(row), columns(column), matrix(row * column, cell)
+{
+}
+
+template <typename T>
+template <typename E, typename>
+Matrix<T>::Matrix(const E &obj) : Matrix()
+{
+    *this = obj;
+}
+
+// Expressions aliasing the destination, or reading it while its shape
+// changes, are evaluated into a temporary first.
+template <typename T>
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix<T> &>::type Matrix<T>::operator =(const E &obj)
 {
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    const bool reshaped = rows != expression.size1() || columns != expression.size2();
+    if (reshaped ? expression.references(*this) : expression.aliases(*this))
+    {
+        return *this = Matrix<T>(obj);
+    }
+
+    matrix.resize(expression.size1() * expression.size2());
+    rows = expression.size1();
+    columns = expression.size2();
+    matrix_expressions::assign(*this, expression);
+
+    return *this;
 }
 
 template <typename T>
 typename Matrix<T>::size_type Matrix<T>::size1() const
 {
-    return matrix.size();
+    return rows;
 }
 
 template <typename T>
 typename Matrix<T>::size_type Matrix<T>::size2() const
 {
-    return matrix.front().size();
+    return columns;
+}
+
+template <typename T>
+typename Matrix<T>::size_type Matrix<T>::stride() const
+{
+    return columns;
 }
 
 template <typename T>
 void Matrix<T>::resize(const Matrix<T>::size_type row_cnt, const Matrix<T>::size_type column_cnt)
 {
-    matrix.resize(row_cnt);
-    for (row_type &row : matrix)
+    if (column_cnt == columns)
     {
-        row.resize(column_cnt);
+        matrix.resize(row_cnt * column_cnt);
     }
+    else
+    {
+        storage_type result(row_cnt * column_cnt);
+        const size_type m = std::min(rows, row_cnt), n = std::min(columns, column_cnt);
+        for (size_type i = 0u; i < m; ++i)
+        {
+            std::copy_n(matrix.data() + i * columns, n, result.data() + i * column_cnt);
+        }
+        matrix.swap(result);
+    }
+    rows = row_cnt;
+    columns = column_cnt;
 }
 
 template <typename T>
 typename Matrix<T>::reference Matrix<T>::operator ()(const Matrix<T>::size_type i,
     const Matrix<T>::size_type j)
 {
-    return matrix[i][j];
+    return matrix[i * columns + j];
 }
 
 template <typename T>
 typename Matrix<T>::const_reference Matrix<T>::operator ()(const Matrix<T>::size_type i,
     const Matrix<T>::size_type j) const
 {
-    return matrix[i][j];
+    return matrix[i * columns + j];
+}
+
+template <typename T>
+typename Matrix<T>::pointer Matrix<T>::data()
+{
+    return matrix.data();
+}
+
+template <typename T>
+typename Matrix<T>::const_pointer Matrix<T>::data() const
+{
+    return matrix.data();
+}
+
+template <typename T>
+MatrixView<typename Matrix<T>::value_type> Matrix<T>::submatrix(const Matrix<T>::size_type i,
+    const Matrix<T>::size_type j,
+    const Matrix<T>::size_type row_cnt,
+    const Matrix<T>::size_type column_cnt)
+{
+    return MatrixView<value_type>(matrix.data() + i * columns + j, row_cnt, column_cnt, columns);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<T>::value_type> Matrix<T>::submatrix(const Matrix<T>::size_type i,
+    const Matrix<T>::size_type j,
+    const Matrix<T>::size_type row_cnt,
+    const Matrix<T>::size_type column_cnt) const
+{
+    return ConstMatrixView<value_type>(matrix.data() + i * columns + j, row_cnt, column_cnt, columns);
+}
+
+template <typename T>
+MatrixView<typename Matrix<T>::value_type> Matrix<T>::row(const Matrix<T>::size_type i)
+{
+    return submatrix(i, 0u, 1u, columns);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<T>::value_type> Matrix<T>::row(const Matrix<T>::size_type i) const
+{
+    return submatrix(i, 0u, 1u, columns);
+}
+
+template <typename T>
+MatrixView<typename Matrix<T>::value_type> Matrix<T>::column(const Matrix<T>::size_type j)
+{
+    return submatrix(0u, j, rows, 1u);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<T>::value_type> Matrix<T>::column(const Matrix<T>::size_type j) const
+{
+    return submatrix(0u, j, rows, 1u);
+}
+
+template <typename T>
+MatrixView<typename Matrix<T>::value_type> Matrix<T>::diagonal()
+{
+    return MatrixView<value_type>(matrix.data(), std::min(rows, columns), 1u, columns + 1u);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<T>::value_type> Matrix<T>::diagonal() const
+{
+    return ConstMatrixView<value_type>(matrix.data(), std::min(rows, columns), 1u, columns + 1u);
 }
 
 template <typename T>
 void Matrix<T>::zero(const Matrix<T>::size_type row_cnt, const Matrix<T>::size_type column_cnt)
 {
-    matrix.assign(row_cnt, row_type(column_cnt));
+    matrix.assign(row_cnt * column_cnt, value_type());
+    rows = row_cnt;
+    columns = column_cnt;
 }
 
 template <typename T>
 void Matrix<T>::identity(const Matrix<T>::size_type order)
 {
-    matrix.assign(order, row_type(order));
+    zero(order, order);
     for (size_type i = 0u; i < order; ++i)
     {
-        matrix[i][i] = 1.0;
+        matrix[i * order + i] = 1.0;
     }
 }
 
 template <typename T>
 Matrix<T> transpose(const Matrix<T> &rhs)
 {
-    const typename Matrix<T>::size_type m = rhs.matrix.size(), n = rhs.matrix.front().size();
+    const typename Matrix<T>::size_type m = rhs.rows, n = rhs.columns;
     Matrix<T> result(n, m);
-    for (typename Matrix<T>::size_type i = 0u; i < n; ++i)
-    {
-        for (typename Matrix<T>::size_type j = 0u; j < m; ++j)
-        {
-            result.matrix[i][j] = rhs.matrix[j][i];
-        }
-    }
+    matrix_kernels::transpose(m, n, rhs.matrix.data(), n, result.matrix.data(), m);
 
     return result;
 }
@@ -173,20 +297,14 @@ Matrix<T> transpose(const Matrix<T> &rhs)
 template <typename T>
 Matrix<T> &Matrix<T>::transpose()
 {
-    const size_type m = matrix.size(), n = matrix.front().size();
-    if (m == n)
+    if (rows == columns)
     {
-        for (size_type i = 1u; i < m; ++i)
-        {
-            for (size_type j = 0u; j < i; ++j)
-            {
-                std::swap(matrix[i][j], matrix[j][i]);
-            }
-        }
+        matrix_kernels::transpose_square(rows, matrix.data(), columns);
     }
     else
     {
-        *this = transpose(*this);
+        matrix_kernels::transpose_in_place(rows, columns, matrix.data());
+        std::swap(rows, columns);
     }
 
     return *this;
@@ -196,17 +314,21 @@ template <typename T>
 void Matrix<T>::row_switching(const Matrix<T>::size_type i,
     const Matrix<T>::size_type j)
 {
-    std::swap(matrix[i], matrix[j]);
+    if (i != j)
+    {
+        std::swap_ranges(matrix.data() + i * columns, matrix.data() + (i + 1u) * columns, matrix.data() + j * columns);
+    }
 }
 
 template <typename T>
 void Matrix<T>::row_multiplication(const Matrix<T>::value_type alpha,
     const Matrix<T>::size_type i)
 {
-    const size_type size = matrix.front().size();
+    const size_type size = columns;
+    value_type *const row = matrix.data() + i * size;
     for (size_type k = 0u; k < size; ++k)
     {
-        matrix[i][k] *= alpha;
+        row[k] *= alpha;
     }
 }
 
@@ -215,10 +337,12 @@ void Matrix<T>::row_addition(const Matrix<T>::size_type i,
     const Matrix<T>::value_type alpha,
     const Matrix<T>::size_type j)
 {
-    const size_type size = matrix.front().size();
+    const size_type size = columns;
+    value_type *const target = matrix.data() + i * size;
+    const value_type *const source = matrix.data() + j * size;
     for (size_type k = 0u; k < size; ++k)
     {
-        matrix[i][k] = std::fma(alpha, matrix[j][k], matrix[i][k]);
+        target[k] = std::fma(alpha, source[k], target[k]);
     }
 }
 
@@ -228,59 +352,18 @@ Matrix<T> Matrix<T>::operator +() const
     return *this;
 }
 
-template <typename T>
-Matrix<T> Matrix<T>::operator -() const
-{
-    Matrix<T> result = *this;
-    const size_type m = matrix.size(), n = matrix.front().size();
-    for (size_type i = 0u; i < m; ++i)
-    {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            result.matrix[i][j] = -matrix[i][j];
-        }
-    }
-
-    return result;
-}
-
-template <typename T>
-Matrix<T> operator *(const Matrix<T> &lhs, const typename Matrix<T>::value_type &value)
-{
-    Matrix<T> result = lhs;
-    result *= value;
-    return result;
-}
-
-template <typename T>
-Matrix<T> operator *(const typename Matrix<T>::value_type &value, const Matrix<T> &rhs)
-{
-    return rhs * value;
-}
-
 template <typename T>
 Matrix<T> &Matrix<T>::operator *=(const Matrix<T>::value_type &value)
 {
-    const size_type m = matrix.size(), n = matrix.front().size();
-    for (size_type i = 0u; i < m; ++i)
+    const size_type size = matrix.size();
+    for (size_type k = 0u; k < size; ++k)
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] *= value;
-        }
+        matrix[k] *= value;
     }
 
     return *this;
 }
 
-template <typename T>
-Matrix<T> operator /(const Matrix<T> &lhs, const typename Matrix<T>::value_type &value)
-{
-    Matrix<T> result = lhs;
-    result /= value;
-    return result;
-}
-
 template <typename T>
 Matrix<T> &Matrix<T>::operator /=(const Matrix<T>::value_type &value)
 {
@@ -288,97 +371,51 @@ Matrix<T> &Matrix<T>::operator /=(const Matrix<T>::value_type &value)
     {
         throw std::overflow_error("Division by zero");
     }
-    const size_type m = matrix.size(), n = matrix.front().size();
-    for (size_type i = 0u; i < m; ++i)
+    const size_type size = matrix.size();
+    for (size_type k = 0u; k < size; ++k)
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] /= value;
-        }
+        matrix[k] /= value;
     }
 
     return *this;
 }
 
 template <typename T>
-Matrix<T> operator +(const Matrix<T> &lhs, const Matrix<T> &rhs)
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix<T> &>::type Matrix<T>::operator +=(const E &obj)
 {
-    Matrix<T> result = lhs;
-    result += rhs;
-    return result;
-}
-
-template <typename T>
-Matrix<T> &Matrix<T>::operator +=(const Matrix<T> &rhs)
-{
-    const size_type m = matrix.size(), n = matrix.front().size();
-    if (m != rhs.matrix.size() || n != rhs.matrix.front().size())
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
     {
         throw std::domain_error("Matrices can't be summed");
     }
-
-    for (size_type i = 0u; i < m; ++i)
+    if (expression.aliases(*this))
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] += rhs.matrix[i][j];
-        }
+        return *this += Matrix<T>(obj);
     }
 
-    return *this;
-}
+    matrix_expressions::add(*this, expression, false);
 
-template <typename T>
-Matrix<T> operator -(const Matrix<T> &lhs, const Matrix<T> &rhs)
-{
-    Matrix<T> result = lhs;
-    result -= rhs;
-    return result;
+    return *this;
 }
 
 template <typename T>
-Matrix<T> &Matrix<T>::operator -=(const Matrix<T> &rhs)
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix<T> &>::type Matrix<T>::operator -=(const E &obj)
 {
-    const size_type m = matrix.size(), n = matrix.front().size();
-    if (m != rhs.matrix.size() || n != rhs.matrix.front().size())
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
     {
         throw std::domain_error("Matrices can't be subtracted");
     }
-
-    for (size_type i = 0u; i < m; ++i)
+    if (expression.aliases(*this))
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] -= rhs.matrix[i][j];
-        }
+        return *this -= Matrix<T>(obj);
     }
 
-    return *this;
-}
+    matrix_expressions::add(*this, expression, true);
 
-template <typename T>
-Matrix<T> operator *(const Matrix<T> &lhs, const Matrix<T> &rhs)
-{
-    const typename Matrix<T>::size_type m = lhs.matrix.size(), l = lhs.matrix.front().size(), n = rhs.matrix.front().size();
-    if (l != rhs.matrix.size())
-    {
-        throw std::domain_error("Matrices can't be multiplied");
-    }
-
-    Matrix<T> result;
-    result.zero(m, n);
-    for (typename Matrix<T>::size_type i = 0u; i < m; ++i)
-    {
-        for (typename Matrix<T>::size_type j = 0u; j < n; ++j)
-        {
-            for (typename Matrix<T>::size_type k = 0u; k < l; ++k)
-            {
-                result.matrix[i][j] = std::fma(lhs.matrix[i][k], rhs.matrix[k][j], result.matrix[i][j]);
-            }
-        }
-    }
-
-    return result;
+    return *this;
 }
 
 template <typename T>
@@ -393,13 +430,10 @@ std::istream &operator >>(std::istream &is, Matrix<T> &m)
 {
     typename Matrix<T>::size_type row_cnt, column_cnt;
     is >> row_cnt >> column_cnt;
-    m.matrix.assign(row_cnt, typename Matrix<T>::row_type(column_cnt));
-    for (typename Matrix<T>::row_type &row : m.matrix)
+    m.zero(row_cnt, column_cnt);
+    for (typename Matrix<T>::value_type &value : m.matrix)
     {
-        for (typename Matrix<T>::value_type &value : row)
-        {
-            is >> value;
-        }
+        is >> value;
     }
 
     return is;
@@ -408,12 +442,12 @@ std::istream &operator >>(std::istream &is, Matrix<T> &m)
 template <typename T>
 std::ostream &operator <<(std::ostream &os, const Matrix<T> &m)
 {
-    os << m.matrix.size() << ' ' << m.matrix.front().size() << '\n';
-    for (const typename Matrix<T>::row_type &row : m.matrix)
+    os << m.rows << ' ' << m.columns << '\n';
+    for (typename Matrix<T>::size_type i = 0u; i < m.rows; ++i)
     {
-        for (const typename Matrix<T>::value_type &value : row)
+        for (typename Matrix<T>::size_type j = 0u; j < m.columns; ++j)
         {
-            os << value << ' ';
+            os << m.matrix[i * m.columns + j] << ' ';
         }
         os << '\n';
     }
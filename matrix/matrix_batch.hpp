@@ -0,0 +1,517 @@
+#ifndef __MATRIX_BATCH_HPP__
+#define __MATRIX_BATCH_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+#include "./matrix.hpp"
+
+// Kernels for batches of small matrices stored block-interleaved: a block
+// holds lanes matrices, element (i, j) of all of them next to each other, so
+// one element of a block fills a 64-byte vector. Every kernel works on one
+// block at a time, on whole elements, so the arithmetic runs across the batch;
+// the x86 versions are the generic code compiled, through flatten and a
+// target attribute, for AVX2 and AVX-512, and the widest one the CPU supports
+// is picked at run time like the gemm kernels.
+namespace matrix_kernels
+{
+    template <typename T>
+    struct BatchLanes : std::integral_constant<std::size_t, 64u / sizeof(T)>
+    {
+    };
+
+    // One element of a block: GCC vector arithmetic works lane by lane and is
+    // lowered to whatever vector width the surrounding target has.
+    template <typename T>
+    struct BatchVector
+    {
+        typedef T type __attribute__((vector_size(64), aligned(64), may_alias));
+    };
+
+    // C = A * B for blocks consecutive blocks.
+    template <typename T>
+    using batch_multiply_type = void (*)(std::size_t, const T *, const T *, T *);
+    // X = A^-1 * B, or A^-1 when B is null, for blocks consecutive blocks
+    // holding count matrices; true when one of them is singular.
+    template <typename T>
+    using batch_solve_type = bool (*)(std::size_t, std::size_t, const T *, const T *, T *);
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    void batch_multiply_block(const T *, const T *, T *);
+    template <typename T, std::size_t N, std::size_t K>
+    bool batch_solve_block(std::size_t, const T *, const T *, T *);
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    void generic_batch_multiply(std::size_t, const T *, const T *, T *);
+    template <typename T, std::size_t N, std::size_t K>
+    bool generic_batch_solve(std::size_t, std::size_t, const T *, const T *, T *);
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    batch_multiply_type<T> select_batch_multiply();
+    template <typename T, std::size_t N, std::size_t K>
+    batch_solve_type<T> select_batch_solve();
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    batch_multiply_type<T> batch_multiply_kernel();
+    template <typename T, std::size_t N, std::size_t K>
+    batch_solve_type<T> batch_solve_kernel();
+    template <typename Function>
+    void for_blocks(std::size_t, double, const Function &);
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    void batch_multiply_block(const T *const a, const T *const b, T *const c)
+    {
+        typedef typename BatchVector<T>::type V;
+        const V *const x = reinterpret_cast<const V *>(a), *const y = reinterpret_cast<const V *>(b);
+        V product[R * K] = {};
+        for (std::size_t i = 0u; i < R; ++i)
+        {
+            for (std::size_t k = 0u; k < K; ++k)
+            {
+                for (std::size_t p = 0u; p < C; ++p)
+                {
+                    product[i * K + k] += x[i * C + p] * y[p * K + k];
+                }
+            }
+        }
+        std::copy_n(product, R * K, reinterpret_cast<V *>(c));
+    }
+
+    // Gaussian elimination with partial pivoting on every lane at once: each
+    // lane swaps in a row whenever it has a larger entry in the pivot column,
+    // through selects, so the lanes pivot independently without branches.
+    // Lanes from used on are padding. A zero pivot is replaced by one to keep
+    // the arithmetic finite, and reported.
+    template <typename T, std::size_t N, std::size_t K>
+    bool batch_solve_block(const std::size_t used, const T *const a, const T *const b, T *const x)
+    {
+        typedef typename BatchVector<T>::type V;
+        const V zero = V(), one = zero + T(1);
+        V u[N * N], y[N * K], inverse[N], failed = zero;
+        std::copy_n(reinterpret_cast<const V *>(a), N * N, u);
+        for (std::size_t e = 0u; e < N * K; ++e)
+        {
+            y[e] = b ? reinterpret_cast<const V *>(b)[e] : e / K == e % K ? one : zero;
+        }
+
+        for (std::size_t j = 0u; j < N; ++j)
+        {
+            for (std::size_t i = j + 1u; i < N; ++i)
+            {
+                const V candidate = u[i * N + j], current = u[j * N + j];
+                const auto swap = (candidate < zero ? -candidate : candidate) > (current < zero ? -current : current);
+                for (std::size_t c = j; c < N; ++c)
+                {
+                    const V p = u[j * N + c], q = u[i * N + c];
+                    u[j * N + c] = swap ? q : p;
+                    u[i * N + c] = swap ? p : q;
+                }
+                for (std::size_t c = 0u; c < K; ++c)
+                {
+                    const V p = y[j * K + c], q = y[i * K + c];
+                    y[j * K + c] = swap ? q : p;
+                    y[i * K + c] = swap ? p : q;
+                }
+            }
+
+            const V pivot = u[j * N + j];
+            const auto singular = pivot == zero;
+            failed = singular ? one : failed;
+            inverse[j] = one / (singular ? one : pivot);
+            for (std::size_t i = j + 1u; i < N; ++i)
+            {
+                const V factor = u[i * N + j] * inverse[j];
+                for (std::size_t c = j + 1u; c < N; ++c)
+                {
+                    u[i * N + c] -= factor * u[j * N + c];
+                }
+                for (std::size_t c = 0u; c < K; ++c)
+                {
+                    y[i * K + c] -= factor * y[j * K + c];
+                }
+            }
+        }
+
+        for (std::size_t i = N; i-- > 0u;)
+        {
+            for (std::size_t c = 0u; c < K; ++c)
+            {
+                V sum = y[i * K + c];
+                for (std::size_t k = i + 1u; k < N; ++k)
+                {
+                    sum -= u[i * N + k] * y[k * K + c];
+                }
+                y[i * K + c] = sum * inverse[i];
+            }
+        }
+        std::copy_n(y, N * K, reinterpret_cast<V *>(x));
+
+        T flags[BatchLanes<T>::value];
+        std::copy_n(reinterpret_cast<const T *>(&failed), BatchLanes<T>::value, flags);
+        return std::any_of(flags, flags + std::min(used, BatchLanes<T>::value), [](const T flag) { return flag != T(0); });
+    }
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    void generic_batch_multiply(const std::size_t blocks, const T *const a, const T *const b, T *const c)
+    {
+        constexpr std::size_t W = BatchLanes<T>::value;
+        for (std::size_t k = 0u; k < blocks; ++k)
+        {
+            batch_multiply_block<T, R, C, K>(a + k * R * C * W, b + k * C * K * W, c + k * R * K * W);
+        }
+    }
+
+    template <typename T, std::size_t N, std::size_t K>
+    bool generic_batch_solve(const std::size_t blocks, const std::size_t count, const T *const a, const T *const b, T *const x)
+    {
+        constexpr std::size_t W = BatchLanes<T>::value;
+        bool singular = false;
+        for (std::size_t k = 0u; k < blocks; ++k)
+        {
+            singular |= batch_solve_block<T, N, K>(count - k * W, a + k * N * N * W, b ? b + k * N * K * W : nullptr,
+                x + k * N * K * W);
+        }
+
+        return singular;
+    }
+
+#ifdef MATRIX_X86_KERNELS
+    namespace haswell
+    {
+        template <typename T, std::size_t R, std::size_t C, std::size_t K>
+        __attribute__((target("avx2,fma"), flatten))
+        void batch_multiply(const std::size_t blocks, const T *const a, const T *const b, T *const c)
+        {
+            generic_batch_multiply<T, R, C, K>(blocks, a, b, c);
+        }
+
+        template <typename T, std::size_t N, std::size_t K>
+        __attribute__((target("avx2,fma"), flatten))
+        bool batch_solve(const std::size_t blocks, const std::size_t count, const T *const a, const T *const b, T *const x)
+        {
+            return generic_batch_solve<T, N, K>(blocks, count, a, b, x);
+        }
+    }
+
+    namespace skylake_avx512
+    {
+        template <typename T, std::size_t R, std::size_t C, std::size_t K>
+        __attribute__((target("avx512f"), flatten))
+        void batch_multiply(const std::size_t blocks, const T *const a, const T *const b, T *const c)
+        {
+            generic_batch_multiply<T, R, C, K>(blocks, a, b, c);
+        }
+
+        template <typename T, std::size_t N, std::size_t K>
+        __attribute__((target("avx512f"), flatten))
+        bool batch_solve(const std::size_t blocks, const std::size_t count, const T *const a, const T *const b, T *const x)
+        {
+            return generic_batch_solve<T, N, K>(blocks, count, a, b, x);
+        }
+    }
+#endif
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    batch_multiply_type<T> select_batch_multiply()
+    {
+#ifdef MATRIX_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return &skylake_avx512::batch_multiply<T, R, C, K>;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return &haswell::batch_multiply<T, R, C, K>;
+        }
+#endif
+        return &generic_batch_multiply<T, R, C, K>;
+    }
+
+    template <typename T, std::size_t N, std::size_t K>
+    batch_solve_type<T> select_batch_solve()
+    {
+#ifdef MATRIX_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return &skylake_avx512::batch_solve<T, N, K>;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return &haswell::batch_solve<T, N, K>;
+        }
+#endif
+        return &generic_batch_solve<T, N, K>;
+    }
+
+    template <typename T, std::size_t R, std::size_t C, std::size_t K>
+    batch_multiply_type<T> batch_multiply_kernel()
+    {
+        static const batch_multiply_type<T> instance(select_batch_multiply<T, R, C, K>());
+        return instance;
+    }
+
+    template <typename T, std::size_t N, std::size_t K>
+    batch_solve_type<T> batch_solve_kernel()
+    {
+        static const batch_solve_type<T> instance(select_batch_solve<T, N, K>());
+        return instance;
+    }
+
+    // Calls function(first, last) on ranges of blocks covering blocks; one
+    // range per thread on the gemm pool when work, in multiply-adds, reaches
+    // parallel_cutoff().
+    template <typename Function>
+    void for_blocks(const std::size_t blocks, const double work, const Function &function)
+    {
+        ThreadPool *const workers = work >= double(parallel_cutoff()) ? pool() : nullptr;
+        if (!workers || blocks < 2u)
+        {
+            function(std::size_t(0u), blocks);
+            return;
+        }
+
+        const std::size_t count = std::min(workers->size() + 1u, blocks);
+        workers->run(count, [&](const std::size_t part)
+        {
+            function(blocks * part / count, blocks * (part + 1u) / count);
+        });
+    }
+}
+
+// size() independent R x C matrices in the layout above: matrix k is lane
+// k % lanes of block k / lanes. The lanes past size() in the last block are
+// padding.
+template <typename T, std::size_t R, std::size_t C>
+class MatrixBatch
+{
+public:
+    typedef Matrix<T, R, C> matrix_type;
+    typedef typename matrix_type::value_type value_type;
+    typedef value_type &reference;
+    typedef const value_type &const_reference;
+    typedef value_type *pointer;
+    typedef const value_type *const_pointer;
+    typedef std::size_t size_type;
+
+    static constexpr const size_type lanes = matrix_kernels::BatchLanes<value_type>::value;
+    static constexpr const size_type block_size = R * C * lanes;
+
+private:
+    size_type count = 0u;
+    matrix_kernels::Buffer<value_type> elements;
+
+public:
+    MatrixBatch() = default;
+    explicit MatrixBatch(size_type);
+
+    size_type size() const;
+    size_type blocks() const;
+    void resize(size_type);
+    reference operator ()(size_type, size_type, size_type);
+    const_reference operator ()(size_type, size_type, size_type) const;
+    pointer data();
+    const_pointer data() const;
+
+    matrix_type get(size_type) const;
+    void set(size_type, const matrix_type &);
+};
+
+template <typename T, std::size_t R, std::size_t C, std::size_t K>
+void multiply(const MatrixBatch<T, R, C> &, const MatrixBatch<T, C, K> &, MatrixBatch<T, R, K> &);
+template <typename T, std::size_t R, std::size_t C, std::size_t K>
+MatrixBatch<T, R, K> operator *(const MatrixBatch<T, R, C> &, const MatrixBatch<T, C, K> &);
+template <typename T, std::size_t N, std::size_t K>
+void solve(const MatrixBatch<T, N, N> &, const MatrixBatch<T, N, K> &, MatrixBatch<T, N, K> &);
+template <typename T, std::size_t N, std::size_t K>
+MatrixBatch<T, N, K> solve(const MatrixBatch<T, N, N> &, const MatrixBatch<T, N, K> &);
+template <typename T, std::size_t N>
+void inverse(const MatrixBatch<T, N, N> &, MatrixBatch<T, N, N> &);
+template <typename T, std::size_t N>
+MatrixBatch<T, N, N> inverse(const MatrixBatch<T, N, N> &);
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr const typename MatrixBatch<T, R, C>::size_type MatrixBatch<T, R, C>::lanes;
+template <typename T, std::size_t R, std::size_t C>
+constexpr const typename MatrixBatch<T, R, C>::size_type MatrixBatch<T, R, C>::block_size;
+
+// Zero matrices.
+template <typename T, std::size_t R, std::size_t C>
+MatrixBatch<T, R, C>::MatrixBatch(const size_type size) : count(size), elements((size + lanes - 1u) / lanes * block_size)
+{
+}
+
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::size_type MatrixBatch<T, R, C>::size() const
+{
+    return count;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::size_type MatrixBatch<T, R, C>::blocks() const
+{
+    return elements.size() / block_size;
+}
+
+// Matrices past the old size are zero.
+template <typename T, std::size_t R, std::size_t C>
+void MatrixBatch<T, R, C>::resize(const size_type size)
+{
+    if (size < count)
+    {
+        for (size_type k = size; k < std::min(count, (size + lanes - 1u) / lanes * lanes); ++k)
+        {
+            set(k, matrix_type());
+        }
+    }
+    elements.resize((size + lanes - 1u) / lanes * block_size);
+    count = size;
+}
+
+// Element (i, j) of matrix k.
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::reference MatrixBatch<T, R, C>::operator ()(const size_type k, const size_type i,
+    const size_type j)
+{
+    return elements[k / lanes * block_size + (i * C + j) * lanes + k % lanes];
+}
+
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::const_reference MatrixBatch<T, R, C>::operator ()(const size_type k, const size_type i,
+    const size_type j) const
+{
+    return elements[k / lanes * block_size + (i * C + j) * lanes + k % lanes];
+}
+
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::pointer MatrixBatch<T, R, C>::data()
+{
+    return elements.data();
+}
+
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::const_pointer MatrixBatch<T, R, C>::data() const
+{
+    return elements.data();
+}
+
+template <typename T, std::size_t R, std::size_t C>
+typename MatrixBatch<T, R, C>::matrix_type MatrixBatch<T, R, C>::get(const size_type k) const
+{
+    matrix_type result;
+    const value_type *const source = elements.data() + k / lanes * block_size + k % lanes;
+    for (size_type e = 0u; e < R * C; ++e)
+    {
+        result.data()[e] = source[e * lanes];
+    }
+
+    return result;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+void MatrixBatch<T, R, C>::set(const size_type k, const matrix_type &obj)
+{
+    value_type *const target = elements.data() + k / lanes * block_size + k % lanes;
+    for (size_type e = 0u; e < R * C; ++e)
+    {
+        target[e * lanes] = obj.data()[e];
+    }
+}
+
+namespace matrix_kernels
+{
+    template <typename T, std::size_t N, std::size_t K>
+    void batch_solve(const MatrixBatch<T, N, N> &lhs, const MatrixBatch<T, N, K> *const rhs, MatrixBatch<T, N, K> &result)
+    {
+        typedef typename MatrixBatch<T, N, K>::value_type value_type;
+
+        const std::size_t count = lhs.size(), W = lhs.lanes;
+        result.resize(count);
+        const batch_solve_type<value_type> kernel = batch_solve_kernel<value_type, N, K>();
+        std::atomic<bool> singular(false);
+        for_blocks(lhs.blocks(), double(count) * double(N * N * (N + K)), [&](const std::size_t first, const std::size_t last)
+        {
+            if (kernel(last - first, std::min(count - first * W, (last - first) * W), lhs.data() + first * lhs.block_size,
+                rhs ? rhs->data() + first * rhs->block_size : nullptr, result.data() + first * result.block_size))
+            {
+                singular.store(true, std::memory_order_relaxed);
+            }
+        });
+        if (singular.load(std::memory_order_relaxed))
+        {
+            throw std::domain_error("Matrix is singular");
+        }
+    }
+}
+
+// result[k] = lhs[k] * rhs[k] for every k. The result is resized to fit and
+// may be one of the operands; reusing one across calls saves allocating and
+// clearing it.
+template <typename T, std::size_t R, std::size_t C, std::size_t K>
+void multiply(const MatrixBatch<T, R, C> &lhs, const MatrixBatch<T, C, K> &rhs, MatrixBatch<T, R, K> &result)
+{
+    typedef typename MatrixBatch<T, R, K>::value_type value_type;
+
+    if (lhs.size() != rhs.size())
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    result.resize(lhs.size());
+    const matrix_kernels::batch_multiply_type<value_type> kernel = matrix_kernels::batch_multiply_kernel<value_type, R, C, K>();
+    matrix_kernels::for_blocks(lhs.blocks(), double(lhs.size()) * double(R * C * K), [&](const std::size_t first, const std::size_t last)
+    {
+        kernel(last - first, lhs.data() + first * lhs.block_size, rhs.data() + first * rhs.block_size,
+            result.data() + first * result.block_size);
+    });
+}
+
+template <typename T, std::size_t R, std::size_t C, std::size_t K>
+MatrixBatch<T, R, K> operator *(const MatrixBatch<T, R, C> &lhs, const MatrixBatch<T, C, K> &rhs)
+{
+    MatrixBatch<T, R, K> result;
+    multiply(lhs, rhs, result);
+
+    return result;
+}
+
+// result[k] with lhs[k] * result[k] = rhs[k] for every k, by LU with partial
+// pivoting; throws if any lhs[k] is singular. The result may be rhs.
+template <typename T, std::size_t N, std::size_t K>
+void solve(const MatrixBatch<T, N, N> &lhs, const MatrixBatch<T, N, K> &rhs, MatrixBatch<T, N, K> &result)
+{
+    if (lhs.size() != rhs.size())
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    matrix_kernels::batch_solve(lhs, &rhs, result);
+}
+
+template <typename T, std::size_t N, std::size_t K>
+MatrixBatch<T, N, K> solve(const MatrixBatch<T, N, N> &lhs, const MatrixBatch<T, N, K> &rhs)
+{
+    MatrixBatch<T, N, K> result;
+    solve(lhs, rhs, result);
+
+    return result;
+}
+
+// The result may be obj.
+template <typename T, std::size_t N>
+void inverse(const MatrixBatch<T, N, N> &obj, MatrixBatch<T, N, N> &result)
+{
+    matrix_kernels::batch_solve<T, N, N>(obj, nullptr, result);
+}
+
+template <typename T, std::size_t N>
+MatrixBatch<T, N, N> inverse(const MatrixBatch<T, N, N> &obj)
+{
+    MatrixBatch<T, N, N> result;
+    inverse(obj, result);
+
+    return result;
+}
+
+#endif
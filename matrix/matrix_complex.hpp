@@ -13,13 +13,15 @@ public:
     typedef std::complex<floating_point> value_type;
 
 private:
-    typedef std::vector<value_type> row_type;
+    typedef std::vector<value_type, AlignedAllocator<value_type>> storage_type;
 
 public:
-    typedef typename row_type::reference reference;
-    typedef typename row_type::const_reference const_reference;
-    typedef typename row_type::size_type size_type;
-    typedef typename row_type::difference_type difference_type;
+    typedef typename storage_type::reference reference;
+    typedef typename storage_type::const_reference const_reference;
+    typedef typename storage_type::pointer pointer;
+    typedef typename storage_type::const_pointer const_pointer;
+    typedef typename storage_type::size_type size_type;
+    typedef typename storage_type::difference_type difference_type;
 
     static constexpr const floating_point value_epsilon = std::numeric_limits<floating_point>::epsilon();
     static constexpr const floating_point value_round_error = std::numeric_limits<floating_point>::round_error();
@@ -27,7 +29,9 @@ public:
     static constexpr const size_type size_max = std::numeric_limits<size_type>::max();
 
 private:
-    std::vector<row_type> matrix;
+    size_type rows = 0u;
+    size_type columns = 0u;
+    storage_type matrix;
 
 public:
     Matrix() = default;
@@ -39,11 +43,28 @@ public:
     Matrix &operator =(Matrix &&) = default;
     ~Matrix() = default;
 
+    template <typename E, typename = typename std::enable_if<matrix_expressions::is_expression<E>::value>::type>
+    Matrix(const E &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix &>::type operator =(const E &);
+
     size_type size1() const;
     size_type size2() const;
+    size_type stride() const;
     void resize(size_type, size_type);
     reference operator ()(size_type, size_type);
     const_reference operator ()(size_type, size_type) const;
+    pointer data();
+    const_pointer data() const;
+
+    MatrixView<value_type> submatrix(size_type, size_type, size_type, size_type);
+    ConstMatrixView<value_type> submatrix(size_type, size_type, size_type, size_type) const;
+    MatrixView<value_type> row(size_type);
+    ConstMatrixView<value_type> row(size_type) const;
+    MatrixView<value_type> column(size_type);
+    ConstMatrixView<value_type> column(size_type) const;
+    MatrixView<value_type> diagonal();
+    ConstMatrixView<value_type> diagonal() const;
 
     void zero(size_type, size_type);
     void identity(size_type);
@@ -57,27 +78,14 @@ public:
     void row_addition(size_type, value_type, size_type);
 
     Matrix operator +() const;
-    Matrix operator -() const;
 
-    template <typename S>
-    friend Matrix<std::complex<S>> operator *(const Matrix<std::complex<S>> &, const typename Matrix<std::complex<S>>::value_type &);
-    template <typename S>
-    friend Matrix<std::complex<S>> operator *(const typename Matrix<std::complex<S>>::value_type &, const Matrix<std::complex<S>> &);
     Matrix &operator *=(const value_type &);
-    template <typename S>
-    friend Matrix<std::complex<S>> operator /(const Matrix<std::complex<S>> &, const typename Matrix<std::complex<S>>::value_type &);
     Matrix &operator /=(const value_type &);
 
-    template <typename S>
-    friend Matrix<std::complex<S>> operator +(const Matrix<std::complex<S>> &, const Matrix<std::complex<S>> &);
-    Matrix &operator +=(const Matrix &);
-
-    template <typename S>
-    friend Matrix<std::complex<S>> operator -(const Matrix<std::complex<S>> &, const Matrix<std::complex<S>> &);
-    Matrix &operator -=(const Matrix &);
-
-    template <typename S>
-    friend Matrix<std::complex<S>> operator *(const Matrix<std::complex<S>> &, const Matrix<std::complex<S>> &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix &>::type operator +=(const E &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix &>::type operator -=(const E &);
     Matrix &operator *=(const Matrix &);
 
     template <typename S>
@@ -88,81 +96,188 @@ public:
 
 template <typename T>
 Matrix<std::complex<T>>::Matrix(const Matrix<std::complex<T>>::size_type row,
-    const Matrix<std::complex<T>>::size_type column) : matrix(row, row_type(column))
+    const Matrix<std::complex<T>>::size_type column) : rows(row), columns(column), matrix(row * column)
 {
 }
 
 template <typename T>
 Matrix<std::complex<T>>::Matrix(const Matrix<std::complex<T>>::size_type row,
     const Matrix<std::complex<T>>::size_type column,
-    const Matrix<std::complex<T>>::value_type &cell) : matrix(row, row_type(column, cell))
+    const Matrix<std::complex<T>>::value_type &cell) : rows(row), columns(column), matrix(row * column, cell)
 {
 }
 
+template <typename T>
+template <typename E, typename>
+Matrix<std::complex<T>>::Matrix(const E &obj) : Matrix()
+{
+    *this = obj;
+}
+
+// Expressions aliasing the destination, or reading it while its shape
+// changes, are evaluated into a temporary first.
+template <typename T>
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix<std::complex<T>> &>::type Matrix<std::complex<T>>::operator =(const E &obj)
+{
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    const bool reshaped = rows != expression.size1() || columns != expression.size2();
+    if (reshaped ? expression.references(*this) : expression.aliases(*this))
+    {
+        return *this = Matrix<std::complex<T>>(obj);
+    }
+
+    matrix.resize(expression.size1() * expression.size2());
+    rows = expression.size1();
+    columns = expression.size2();
+    matrix_expressions::assign(*this, expression);
+
+    return *this;
+}
+
 template <typename T>
 typename Matrix<std::complex<T>>::size_type Matrix<std::complex<T>>::size1() const
 {
-    return matrix.size();
+    return rows;
 }
 
 template <typename T>
 typename Matrix<std::complex<T>>::size_type Matrix<std::complex<T>>::size2() const
 {
-    return matrix.front().size();
+    return columns;
+}
+
+template <typename T>
+typename Matrix<std::complex<T>>::size_type Matrix<std::complex<T>>::stride() const
+{
+    return columns;
 }
 
 template <typename T>
 void Matrix<std::complex<T>>::resize(const Matrix<std::complex<T>>::size_type row_cnt, const Matrix<std::complex<T>>::size_type column_cnt)
 {
-    matrix.resize(row_cnt);
-    for (row_type &row : matrix)
+    if (column_cnt == columns)
+    {
+        matrix.resize(row_cnt * column_cnt);
+    }
+    else
     {
-        row.resize(column_cnt);
+        storage_type result(row_cnt * column_cnt);
+        const size_type m = std::min(rows, row_cnt), n = std::min(columns, column_cnt);
+        for (size_type i = 0u; i < m; ++i)
+        {
+            std::copy_n(matrix.data() + i * columns, n, result.data() + i * column_cnt);
+        }
+        matrix.swap(result);
     }
+    rows = row_cnt;
+    columns = column_cnt;
 }
 
 template <typename T>
 typename Matrix<std::complex<T>>::reference Matrix<std::complex<T>>::operator ()(const Matrix<std::complex<T>>::size_type i,
     const Matrix<std::complex<T>>::size_type j)
 {
-    return matrix[i][j];
+    return matrix[i * columns + j];
 }
 
 template <typename T>
 typename Matrix<std::complex<T>>::const_reference Matrix<std::complex<T>>::operator ()(const Matrix<std::complex<T>>::size_type i,
     const Matrix<std::complex<T>>::size_type j) const
 {
-    return matrix[i][j];
+    return matrix[i * columns + j];
+}
+
+template <typename T>
+typename Matrix<std::complex<T>>::pointer Matrix<std::complex<T>>::data()
+{
+    return matrix.data();
+}
+
+template <typename T>
+typename Matrix<std::complex<T>>::const_pointer Matrix<std::complex<T>>::data() const
+{
+    return matrix.data();
+}
+
+template <typename T>
+MatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::submatrix(const Matrix<std::complex<T>>::size_type i,
+    const Matrix<std::complex<T>>::size_type j,
+    const Matrix<std::complex<T>>::size_type row_cnt,
+    const Matrix<std::complex<T>>::size_type column_cnt)
+{
+    return MatrixView<value_type>(matrix.data() + i * columns + j, row_cnt, column_cnt, columns);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::submatrix(const Matrix<std::complex<T>>::size_type i,
+    const Matrix<std::complex<T>>::size_type j,
+    const Matrix<std::complex<T>>::size_type row_cnt,
+    const Matrix<std::complex<T>>::size_type column_cnt) const
+{
+    return ConstMatrixView<value_type>(matrix.data() + i * columns + j, row_cnt, column_cnt, columns);
+}
+
+template <typename T>
+MatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::row(const Matrix<std::complex<T>>::size_type i)
+{
+    return submatrix(i, 0u, 1u, columns);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::row(const Matrix<std::complex<T>>::size_type i) const
+{
+    return submatrix(i, 0u, 1u, columns);
+}
+
+template <typename T>
+MatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::column(const Matrix<std::complex<T>>::size_type j)
+{
+    return submatrix(0u, j, rows, 1u);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::column(const Matrix<std::complex<T>>::size_type j) const
+{
+    return submatrix(0u, j, rows, 1u);
+}
+
+template <typename T>
+MatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::diagonal()
+{
+    return MatrixView<value_type>(matrix.data(), std::min(rows, columns), 1u, columns + 1u);
+}
+
+template <typename T>
+ConstMatrixView<typename Matrix<std::complex<T>>::value_type> Matrix<std::complex<T>>::diagonal() const
+{
+    return ConstMatrixView<value_type>(matrix.data(), std::min(rows, columns), 1u, columns + 1u);
 }
 
 template <typename T>
 void Matrix<std::complex<T>>::zero(const Matrix<std::complex<T>>::size_type row_cnt, const Matrix<std::complex<T>>::size_type column_cnt)
 {
-    matrix.assign(row_cnt, row_type(column_cnt));
+    matrix.assign(row_cnt * column_cnt, value_type());
+    rows = row_cnt;
+    columns = column_cnt;
 }
 
 template <typename T>
 void Matrix<std::complex<T>>::identity(const Matrix<std::complex<T>>::size_type order)
 {
-    matrix.assign(order, row_type(order));
+    zero(order, order);
     for (size_type i = 0u; i < order; ++i)
     {
-        matrix[i][i] = 1.0;
+        matrix[i * order + i] = 1.0;
     }
 }
 
 template <typename T>
 Matrix<std::complex<T>> transpose(const Matrix<std::complex<T>> &rhs)
 {
-    const typename Matrix<std::complex<T>>::size_type m = rhs.matrix.size(), n = rhs.matrix.front().size();
+    const typename Matrix<std::complex<T>>::size_type m = rhs.rows, n = rhs.columns;
     Matrix<std::complex<T>> result(n, m);
-    for (typename Matrix<std::complex<T>>::size_type i = 0u; i < n; ++i)
-    {
-        for (typename Matrix<std::complex<T>>::size_type j = 0u; j < m; ++j)
-        {
-            result.matrix[i][j] = rhs.matrix[j][i];
-        }
-    }
+    matrix_kernels::transpose(m, n, rhs.matrix.data(), n, result.matrix.data(), m);
 
     return result;
 }
@@ -170,20 +285,14 @@ Matrix<std::complex<T>> transpose(const Matrix<std::complex<T>> &rhs)
 template <typename T>
 Matrix<std::complex<T>> &Matrix<std::complex<T>>::transpose()
 {
-    const size_type m = matrix.size(), n = matrix.front().size();
-    if (m == n)
+    if (rows == columns)
     {
-        for (size_type i = 1u; i < m; ++i)
-        {
-            for (size_type j = 0u; j < i; ++j)
-            {
-                std::swap(matrix[i][j], matrix[j][i]);
-            }
-        }
+        matrix_kernels::transpose_square(rows, matrix.data(), columns);
     }
     else
     {
-        *this = transpose(*this);
+        matrix_kernels::transpose_in_place(rows, columns, matrix.data());
+        std::swap(rows, columns);
     }
 
     return *this;
@@ -193,17 +302,21 @@ template <typename T>
 void Matrix<std::complex<T>>::row_switching(const Matrix<std::complex<T>>::size_type i,
     const Matrix<std::complex<T>>::size_type j)
 {
-    std::swap(matrix[i], matrix[j]);
+    if (i != j)
+    {
+        std::swap_ranges(matrix.data() + i * columns, matrix.data() + (i + 1u) * columns, matrix.data() + j * columns);
+    }
 }
 
 template <typename T>
 void Matrix<std::complex<T>>::row_multiplication(const Matrix<std::complex<T>>::value_type alpha,
     const Matrix<std::complex<T>>::size_type i)
 {
-    const size_type size = matrix.front().size();
+    const size_type size = columns;
+    value_type *const row = matrix.data() + i * size;
     for (size_type k = 0u; k < size; ++k)
     {
-        matrix[i][k] *= alpha;
+        row[k] *= alpha;
     }
 }
 
@@ -212,10 +325,12 @@ void Matrix<std::complex<T>>::row_addition(const Matrix<std::complex<T>>::size_t
     const Matrix<std::complex<T>>::value_type alpha,
     const Matrix<std::complex<T>>::size_type j)
 {
-    const size_type size = matrix.front().size();
+    const size_type size = columns;
+    value_type *const target = matrix.data() + i * size;
+    const value_type *const source = matrix.data() + j * size;
     for (size_type k = 0u; k < size; ++k)
     {
-        matrix[i][k] += alpha * matrix[j][k];
+        target[k] += alpha * source[k];
     }
 }
 
@@ -225,59 +340,18 @@ Matrix<std::complex<T>> Matrix<std::complex<T>>::operator +() const
     return *this;
 }
 
-template <typename T>
-Matrix<std::complex<T>> Matrix<std::complex<T>>::operator -() const
-{
-    Matrix<std::complex<T>> result = *this;
-    const size_type m = matrix.size(), n = matrix.front().size();
-    for (size_type i = 0u; i < m; ++i)
-    {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            result.matrix[i][j] = -matrix[i][j];
-        }
-    }
-
-    return result;
-}
-
-template <typename T>
-Matrix<std::complex<T>> operator *(const Matrix<std::complex<T>> &lhs, const typename Matrix<std::complex<T>>::value_type &value)
-{
-    Matrix<std::complex<T>> result = lhs;
-    result *= value;
-    return result;
-}
-
-template <typename T>
-Matrix<std::complex<T>> operator *(const typename Matrix<std::complex<T>>::value_type &value, const Matrix<std::complex<T>> &rhs)
-{
-    return rhs * value;
-}
-
 template <typename T>
 Matrix<std::complex<T>> &Matrix<std::complex<T>>::operator *=(const Matrix<std::complex<T>>::value_type &value)
 {
-    const size_type m = matrix.size(), n = matrix.front().size();
-    for (size_type i = 0u; i < m; ++i)
+    const size_type size = matrix.size();
+    for (size_type k = 0u; k < size; ++k)
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] *= value;
-        }
+        matrix[k] *= value;
     }
 
     return *this;
 }
 
-template <typename T>
-Matrix<std::complex<T>> operator /(const Matrix<std::complex<T>> &lhs, const typename Matrix<std::complex<T>>::value_type &value)
-{
-    Matrix<std::complex<T>> result = lhs;
-    result /= value;
-    return result;
-}
-
 template <typename T>
 Matrix<std::complex<T>> &Matrix<std::complex<T>>::operator /=(const Matrix<std::complex<T>>::value_type &value)
 {
@@ -285,97 +359,51 @@ Matrix<std::complex<T>> &Matrix<std::complex<T>>::operator /=(const Matrix<std::
     {
         throw std::overflow_error("Division by zero");
     }
-    const size_type m = matrix.size(), n = matrix.front().size();
-    for (size_type i = 0u; i < m; ++i)
+    const size_type size = matrix.size();
+    for (size_type k = 0u; k < size; ++k)
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] /= value;
-        }
+        matrix[k] /= value;
     }
 
     return *this;
 }
 
 template <typename T>
-Matrix<std::complex<T>> operator +(const Matrix<std::complex<T>> &lhs, const Matrix<std::complex<T>> &rhs)
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix<std::complex<T>> &>::type Matrix<std::complex<T>>::operator +=(const E &obj)
 {
-    Matrix<std::complex<T>> result = lhs;
-    result += rhs;
-    return result;
-}
-
-template <typename T>
-Matrix<std::complex<T>> &Matrix<std::complex<T>>::operator +=(const Matrix<std::complex<T>> &rhs)
-{
-    const size_type m = matrix.size(), n = matrix.front().size();
-    if (m != rhs.matrix.size() || n != rhs.matrix.front().size())
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
     {
         throw std::domain_error("Matrices can't be summed");
     }
-
-    for (size_type i = 0u; i < m; ++i)
+    if (expression.aliases(*this))
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] += rhs.matrix[i][j];
-        }
+        return *this += Matrix<std::complex<T>>(obj);
     }
 
-    return *this;
-}
+    matrix_expressions::add(*this, expression, false);
 
-template <typename T>
-Matrix<std::complex<T>> operator -(const Matrix<std::complex<T>> &lhs, const Matrix<std::complex<T>> &rhs)
-{
-    Matrix<std::complex<T>> result = lhs;
-    result -= rhs;
-    return result;
+    return *this;
 }
 
 template <typename T>
-Matrix<std::complex<T>> &Matrix<std::complex<T>>::operator -=(const Matrix<std::complex<T>> &rhs)
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, Matrix<std::complex<T>> &>::type Matrix<std::complex<T>>::operator -=(const E &obj)
 {
-    const size_type m = matrix.size(), n = matrix.front().size();
-    if (m != rhs.matrix.size() || n != rhs.matrix.front().size())
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
     {
         throw std::domain_error("Matrices can't be subtracted");
     }
-
-    for (size_type i = 0u; i < m; ++i)
+    if (expression.aliases(*this))
     {
-        for (size_type j = 0u; j < n; ++j)
-        {
-            matrix[i][j] -= rhs.matrix[i][j];
-        }
+        return *this -= Matrix<std::complex<T>>(obj);
     }
 
-    return *this;
-}
+    matrix_expressions::add(*this, expression, true);
 
-template <typename T>
-Matrix<std::complex<T>> operator *(const Matrix<std::complex<T>> &lhs, const Matrix<std::complex<T>> &rhs)
-{
-    const typename Matrix<std::complex<T>>::size_type m = lhs.matrix.size(), l = lhs.matrix.front().size(), n = rhs.matrix.front().size();
-    if (l != rhs.matrix.size())
-    {
-        throw std::domain_error("Matrices can't be multiplied");
-    }
-
-    Matrix<std::complex<T>> result;
-    result.zero(m, n);
-    for (typename Matrix<std::complex<T>>::size_type i = 0u; i < m; ++i)
-    {
-        for (typename Matrix<std::complex<T>>::size_type j = 0u; j < n; ++j)
-        {
-            for (typename Matrix<std::complex<T>>::size_type k = 0u; k < l; ++k)
-            {
-                result.matrix[i][j] += lhs.matrix[i][k] * rhs.matrix[k][j];
-            }
-        }
-    }
-
-    return result;
+    return *this;
 }
 
 template <typename T>
@@ -390,13 +418,10 @@ std::istream &operator >>(std::istream &is, Matrix<std::complex<T>> &m)
 {
     typename Matrix<std::complex<T>>::size_type row_cnt, column_cnt;
     is >> row_cnt >> column_cnt;
-    m.matrix.assign(row_cnt, typename Matrix<std::complex<T>>::row_type(column_cnt));
-    for (typename Matrix<std::complex<T>>::row_type &row : m.matrix)
+    m.zero(row_cnt, column_cnt);
+    for (typename Matrix<std::complex<T>>::value_type &value : m.matrix)
     {
-        for (typename Matrix<std::complex<T>>::value_type &value : row)
-        {
-            is >> value;
-        }
+        is >> value;
     }
 
     return is;
@@ -405,12 +430,12 @@ std::istream &operator >>(std::istream &is, Matrix<std::complex<T>> &m)
 template <typename T>
 std::ostream &operator <<(std::ostream &os, const Matrix<std::complex<T>> &m)
 {
-    os << m.matrix.size() << ' ' << m.matrix.front().size() << '\n';
-    for (const typename Matrix<std::complex<T>>::row_type &row : m.matrix)
+    os << m.rows << ' ' << m.columns << '\n';
+    for (typename Matrix<std::complex<T>>::size_type i = 0u; i < m.rows; ++i)
     {
-        for (const typename Matrix<std::complex<T>>::value_type &value : row)
+        for (typename Matrix<std::complex<T>>::size_type j = 0u; j < m.columns; ++j)
         {
-            os << value << ' ';
+            os << m.matrix[i * m.columns + j] << ' ';
         }
         os << '\n';
     }
@@ -0,0 +1,481 @@
+#ifndef __MATRIX_VIEW_HPP__
+#define __MATRIX_VIEW_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "./expression.hpp"
+
+template <typename T>
+class MatrixView;
+
+// Non-owning windows onto the storage of a Matrix, laid out like it: element
+// (i, j) is at data()[i * stride() + j]. Submatrices and rows keep the stride
+// of their parent, a column is one element per row and a diagonal is a column
+// whose stride also steps over one element. Views are expressions, so they
+// mix with matrices in arithmetic, and products read them in place. A view
+// does not keep its matrix alive; resizing the matrix invalidates it.
+template <typename T>
+class ConstMatrixView
+{
+public:
+    typedef T value_type;
+    typedef const value_type &reference;
+    typedef const value_type &const_reference;
+    typedef const value_type *pointer;
+    typedef const value_type *const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+private:
+    const_pointer elements;
+    size_type rows;
+    size_type columns;
+    size_type step;
+
+public:
+    ConstMatrixView(const_pointer, size_type, size_type, size_type);
+    ConstMatrixView(const MatrixView<T> &);
+
+    size_type size1() const;
+    size_type size2() const;
+    size_type stride() const;
+    const_reference operator ()(size_type, size_type) const;
+    const_pointer data() const;
+
+    ConstMatrixView submatrix(size_type, size_type, size_type, size_type) const;
+    ConstMatrixView row(size_type) const;
+    ConstMatrixView column(size_type) const;
+    ConstMatrixView diagonal() const;
+};
+
+// Assigning to a view writes through to the matrix; the shape must match.
+template <typename T>
+class MatrixView
+{
+public:
+    typedef T value_type;
+    typedef value_type &reference;
+    typedef const value_type &const_reference;
+    typedef value_type *pointer;
+    typedef const value_type *const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+private:
+    pointer elements;
+    size_type rows;
+    size_type columns;
+    size_type step;
+
+public:
+    MatrixView(pointer, size_type, size_type, size_type);
+    MatrixView(const MatrixView &) = default;
+    MatrixView &operator =(const MatrixView &);
+
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, MatrixView &>::type operator =(const E &);
+
+    size_type size1() const;
+    size_type size2() const;
+    size_type stride() const;
+    reference operator ()(size_type, size_type) const;
+    pointer data() const;
+
+    MatrixView submatrix(size_type, size_type, size_type, size_type) const;
+    MatrixView row(size_type) const;
+    MatrixView column(size_type) const;
+    MatrixView diagonal() const;
+
+    void row_switching(size_type, size_type);
+    void row_multiplication(value_type, size_type);
+    void row_addition(size_type, value_type, size_type);
+
+    MatrixView &operator *=(const value_type &);
+    MatrixView &operator /=(const value_type &);
+
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, MatrixView &>::type operator +=(const E &);
+    template <typename E>
+    typename std::enable_if<matrix_expressions::is_expression<E>::value, MatrixView &>::type operator -=(const E &);
+};
+
+namespace matrix_expressions
+{
+    template <typename T>
+    struct is_expression<ConstMatrixView<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_expression<MatrixView<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct operand<ConstMatrixView<T>>
+    {
+        typedef Leaf<ConstMatrixView<T>> type;
+    };
+
+    template <typename T>
+    struct operand<MatrixView<T>>
+    {
+        typedef Leaf<MatrixView<T>> type;
+    };
+
+    // Operands gemm reads through data() and stride().
+    template <typename M>
+    struct is_strided : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_strided<Matrix<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_strided<ConstMatrixView<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_strided<MatrixView<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    T multiply_add(const T &, const T &, const T &);
+    template <typename T>
+    std::complex<T> multiply_add(const std::complex<T> &, const std::complex<T> &, const std::complex<T> &);
+
+    template <typename T>
+    T multiply_add(const T &alpha, const T &x, const T &y)
+    {
+        return std::fma(alpha, x, y);
+    }
+
+    template <typename T>
+    std::complex<T> multiply_add(const std::complex<T> &alpha, const std::complex<T> &x, const std::complex<T> &y)
+    {
+        return y + alpha * x;
+    }
+}
+
+template <typename A, typename B, typename C>
+typename std::enable_if<matrix_expressions::is_strided<A>::value && matrix_expressions::is_strided<B>::value
+    && matrix_expressions::is_strided<typename std::remove_reference<C>::type>::value>::type
+gemm(Transpose, Transpose, const typename A::value_type &, const A &, const B &, const typename A::value_type &, C &&);
+
+template <typename T>
+ConstMatrixView<T>::ConstMatrixView(const ConstMatrixView<T>::const_pointer data,
+    const ConstMatrixView<T>::size_type row_cnt,
+    const ConstMatrixView<T>::size_type column_cnt,
+    const ConstMatrixView<T>::size_type row_stride) : elements(data), rows(row_cnt), columns(column_cnt), step(row_stride)
+{
+}
+
+template <typename T>
+ConstMatrixView<T>::ConstMatrixView(const MatrixView<T> &obj) : elements(obj.data()), rows(obj.size1()),
+    columns(obj.size2()), step(obj.stride())
+{
+}
+
+template <typename T>
+typename ConstMatrixView<T>::size_type ConstMatrixView<T>::size1() const
+{
+    return rows;
+}
+
+template <typename T>
+typename ConstMatrixView<T>::size_type ConstMatrixView<T>::size2() const
+{
+    return columns;
+}
+
+template <typename T>
+typename ConstMatrixView<T>::size_type ConstMatrixView<T>::stride() const
+{
+    return step;
+}
+
+template <typename T>
+typename ConstMatrixView<T>::const_reference ConstMatrixView<T>::operator ()(const ConstMatrixView<T>::size_type i,
+    const ConstMatrixView<T>::size_type j) const
+{
+    return elements[i * step + j];
+}
+
+template <typename T>
+typename ConstMatrixView<T>::const_pointer ConstMatrixView<T>::data() const
+{
+    return elements;
+}
+
+template <typename T>
+ConstMatrixView<T> ConstMatrixView<T>::submatrix(const ConstMatrixView<T>::size_type i,
+    const ConstMatrixView<T>::size_type j,
+    const ConstMatrixView<T>::size_type row_cnt,
+    const ConstMatrixView<T>::size_type column_cnt) const
+{
+    return ConstMatrixView<T>(elements + i * step + j, row_cnt, column_cnt, step);
+}
+
+template <typename T>
+ConstMatrixView<T> ConstMatrixView<T>::row(const ConstMatrixView<T>::size_type i) const
+{
+    return submatrix(i, 0u, 1u, columns);
+}
+
+template <typename T>
+ConstMatrixView<T> ConstMatrixView<T>::column(const ConstMatrixView<T>::size_type j) const
+{
+    return submatrix(0u, j, rows, 1u);
+}
+
+template <typename T>
+ConstMatrixView<T> ConstMatrixView<T>::diagonal() const
+{
+    return ConstMatrixView<T>(elements, std::min(rows, columns), 1u, step + 1u);
+}
+
+template <typename T>
+MatrixView<T>::MatrixView(const MatrixView<T>::pointer data,
+    const MatrixView<T>::size_type row_cnt,
+    const MatrixView<T>::size_type column_cnt,
+    const MatrixView<T>::size_type row_stride) : elements(data), rows(row_cnt), columns(column_cnt), step(row_stride)
+{
+}
+
+template <typename T>
+MatrixView<T> &MatrixView<T>::operator =(const MatrixView<T> &obj)
+{
+    return *this = ConstMatrixView<T>(obj);
+}
+
+// Expressions reading the viewed elements in another layout are evaluated
+// into a temporary first.
+template <typename T>
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, MatrixView<T> &>::type MatrixView<T>::operator =(const E &obj)
+{
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
+    {
+        throw std::domain_error("Matrices can't be assigned");
+    }
+    if (expression.aliases(*this))
+    {
+        return *this = Matrix<T>(obj);
+    }
+
+    matrix_expressions::assign(*this, expression);
+
+    return *this;
+}
+
+template <typename T>
+typename MatrixView<T>::size_type MatrixView<T>::size1() const
+{
+    return rows;
+}
+
+template <typename T>
+typename MatrixView<T>::size_type MatrixView<T>::size2() const
+{
+    return columns;
+}
+
+template <typename T>
+typename MatrixView<T>::size_type MatrixView<T>::stride() const
+{
+    return step;
+}
+
+template <typename T>
+typename MatrixView<T>::reference MatrixView<T>::operator ()(const MatrixView<T>::size_type i,
+    const MatrixView<T>::size_type j) const
+{
+    return elements[i * step + j];
+}
+
+template <typename T>
+typename MatrixView<T>::pointer MatrixView<T>::data() const
+{
+    return elements;
+}
+
+template <typename T>
+MatrixView<T> MatrixView<T>::submatrix(const MatrixView<T>::size_type i,
+    const MatrixView<T>::size_type j,
+    const MatrixView<T>::size_type row_cnt,
+    const MatrixView<T>::size_type column_cnt) const
+{
+    return MatrixView<T>(elements + i * step + j, row_cnt, column_cnt, step);
+}
+
+template <typename T>
+MatrixView<T> MatrixView<T>::row(const MatrixView<T>::size_type i) const
+{
+    return submatrix(i, 0u, 1u, columns);
+}
+
+template <typename T>
+MatrixView<T> MatrixView<T>::column(const MatrixView<T>::size_type j) const
+{
+    return submatrix(0u, j, rows, 1u);
+}
+
+template <typename T>
+MatrixView<T> MatrixView<T>::diagonal() const
+{
+    return MatrixView<T>(elements, std::min(rows, columns), 1u, step + 1u);
+}
+
+template <typename T>
+void MatrixView<T>::row_switching(const MatrixView<T>::size_type i,
+    const MatrixView<T>::size_type j)
+{
+    if (i != j)
+    {
+        std::swap_ranges(elements + i * step, elements + i * step + columns, elements + j * step);
+    }
+}
+
+template <typename T>
+void MatrixView<T>::row_multiplication(const MatrixView<T>::value_type alpha,
+    const MatrixView<T>::size_type i)
+{
+    value_type *const row = elements + i * step;
+    for (size_type k = 0u; k < columns; ++k)
+    {
+        row[k] *= alpha;
+    }
+}
+
+template <typename T>
+void MatrixView<T>::row_addition(const MatrixView<T>::size_type i,
+    const MatrixView<T>::value_type alpha,
+    const MatrixView<T>::size_type j)
+{
+    value_type *const target = elements + i * step;
+    const value_type *const source = elements + j * step;
+    for (size_type k = 0u; k < columns; ++k)
+    {
+        target[k] = matrix_expressions::multiply_add(alpha, source[k], target[k]);
+    }
+}
+
+template <typename T>
+MatrixView<T> &MatrixView<T>::operator *=(const MatrixView<T>::value_type &value)
+{
+    return *this = *this * value;
+}
+
+template <typename T>
+MatrixView<T> &MatrixView<T>::operator /=(const MatrixView<T>::value_type &value)
+{
+    return *this = *this / value;
+}
+
+template <typename T>
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, MatrixView<T> &>::type MatrixView<T>::operator +=(const E &obj)
+{
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
+    {
+        throw std::domain_error("Matrices can't be summed");
+    }
+    if (expression.aliases(*this))
+    {
+        return *this += Matrix<T>(obj);
+    }
+
+    matrix_expressions::add(*this, expression, false);
+
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+typename std::enable_if<matrix_expressions::is_expression<E>::value, MatrixView<T> &>::type MatrixView<T>::operator -=(const E &obj)
+{
+    const typename matrix_expressions::operand<E>::type expression(obj);
+    if (rows != expression.size1() || columns != expression.size2())
+    {
+        throw std::domain_error("Matrices can't be subtracted");
+    }
+    if (expression.aliases(*this))
+    {
+        return *this -= Matrix<T>(obj);
+    }
+
+    matrix_expressions::add(*this, expression, true);
+
+    return *this;
+}
+
+// c = alpha * op(a) * op(b) + beta * c, BLAS-style. a and b are matrices or
+// views, read in place through their strides; c is a matrix or a view that
+// already has the shape of the product and keeps its storage. c is not read
+// when beta is zero, and an operand sharing storage with c is copied first.
+template <typename A, typename B, typename C>
+typename std::enable_if<matrix_expressions::is_strided<A>::value && matrix_expressions::is_strided<B>::value
+    && matrix_expressions::is_strided<typename std::remove_reference<C>::type>::value>::type
+gemm(const Transpose op_a, const Transpose op_b, const typename A::value_type &alpha, const A &a, const B &b,
+    const typename A::value_type &beta, C &&c)
+{
+    typedef typename A::value_type value_type;
+    typedef std::size_t size_type;
+    const bool transpose_a = op_a != NO_TRANSPOSE, transpose_b = op_b != NO_TRANSPOSE;
+    const size_type m = transpose_a ? a.size2() : a.size1(), l = transpose_a ? a.size1() : a.size2();
+    const size_type n = transpose_b ? b.size1() : b.size2();
+    if ((transpose_b ? b.size2() : b.size1()) != l || c.size1() != m || c.size2() != n)
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    if (matrix_expressions::overlaps(a, c))
+    {
+        const Matrix<value_type> operand(a);
+        gemm(op_a, op_b, alpha, operand, b, beta, c);
+        return;
+    }
+    if (matrix_expressions::overlaps(b, c))
+    {
+        const Matrix<value_type> operand(b);
+        gemm(op_a, op_b, alpha, a, operand, beta, c);
+        return;
+    }
+
+    const size_type ldc = c.stride();
+    for (size_type i = 0u; i < m; ++i)
+    {
+        value_type *const row = c.data() + i * ldc;
+        if (beta == value_type())
+        {
+            std::fill(row, row + n, value_type());
+        }
+        else if (beta != value_type(1))
+        {
+            for (size_type j = 0u; j < n; ++j)
+            {
+                row[j] *= beta;
+            }
+        }
+    }
+
+    const std::ptrdiff_t lda = std::ptrdiff_t(a.stride()), ldb = std::ptrdiff_t(b.stride());
+    matrix_kernels::gemm(m, n, l, alpha,
+        a.data(), transpose_a ? 1 : lda, transpose_a ? lda : 1,
+        b.data(), transpose_b ? 1 : ldb, transpose_b ? ldb : 1,
+        c.data(), ldc, op_a == CONJUGATE_TRANSPOSE, op_b == CONJUGATE_TRANSPOSE);
+}
+
+#endif
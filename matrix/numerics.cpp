@@ -0,0 +1,997 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cholesky.hpp"
+#include "lu.hpp"
+#include "matrix_batch.hpp"
+#include "qr.hpp"
+#include "sparse_matrix.hpp"
+
+// Checks the dense products, the factorizations, the sparse products and
+// the batch kernels against naive code: operator* on shapes that leave
+// partial tiles and blocks in the packed gemm, the vectorised micro-kernel
+// against the portable one, Strassen-Winograd against its error bound, lazy
+// expressions that alias their destination or scale products, the transpose
+// flags, beta and overlapping operands of gemm(), writes through strided
+// views and products of views, residuals of LU, Cholesky and QR, SpMV, SpMM
+// and SpGEMM against dense(), and every batch operation against the same
+// operation on each Matrix<T, R, C>. Sizes sit around the block and tile
+// edges. Everything runs on 1, 2, 3 and 8 threads with a parallel cutoff of
+// one multiply-add, so every product splits, also unevenly and into more
+// parts than there are blocks.
+//
+// Usage: numerics
+
+namespace reference
+{
+    template <typename T>
+    struct Magnitude
+    {
+        typedef T type;
+    };
+
+    template <typename T>
+    struct Magnitude<std::complex<T>>
+    {
+        typedef T type;
+    };
+
+    template <typename T>
+    T conjugate(const T &obj)
+    {
+        return obj;
+    }
+
+    template <typename T>
+    std::complex<T> conjugate(const std::complex<T> &obj)
+    {
+        return std::conj(obj);
+    }
+
+    template <typename T>
+    Matrix<T> product(const Matrix<T> &lhs, const Matrix<T> &rhs)
+    {
+        Matrix<T> res(lhs.size1(), rhs.size2());
+        for (std::size_t i = 0u; i < lhs.size1(); ++i)
+        {
+            for (std::size_t p = 0u; p < lhs.size2(); ++p)
+            {
+                for (std::size_t j = 0u; j < rhs.size2(); ++j)
+                {
+                    res(i, j) += lhs(i, p) * rhs(p, j);
+                }
+            }
+        }
+
+        return res;
+    }
+
+    // alpha * x + beta * y.
+    template <typename T>
+    Matrix<T> combination(const T &alpha, const Matrix<T> &x, const T &beta, const Matrix<T> &y)
+    {
+        Matrix<T> res(x.size1(), x.size2());
+        for (std::size_t i = 0u; i < x.size1(); ++i)
+        {
+            for (std::size_t j = 0u; j < x.size2(); ++j)
+            {
+                res(i, j) = alpha * x(i, j) + beta * y(i, j);
+            }
+        }
+
+        return res;
+    }
+
+    template <typename T>
+    Matrix<T> adjoint(const Matrix<T> &obj)
+    {
+        Matrix<T> res(obj.size2(), obj.size1());
+        for (std::size_t i = 0u; i < obj.size1(); ++i)
+        {
+            for (std::size_t j = 0u; j < obj.size2(); ++j)
+            {
+                res(j, i) = conjugate(obj(i, j));
+            }
+        }
+
+        return res;
+    }
+
+    template <typename T>
+    Matrix<T> transposed(const Matrix<T> &obj)
+    {
+        Matrix<T> res(obj.size2(), obj.size1());
+        for (std::size_t i = 0u; i < obj.size1(); ++i)
+        {
+            for (std::size_t j = 0u; j < obj.size2(); ++j)
+            {
+                res(j, i) = obj(i, j);
+            }
+        }
+
+        return res;
+    }
+
+    // op(obj) for the gemm flags.
+    template <typename T>
+    Matrix<T> apply(const Transpose op, const Matrix<T> &obj)
+    {
+        return op == NO_TRANSPOSE ? obj : op == TRANSPOSE ? transposed(obj) : adjoint(obj);
+    }
+
+    // A copy of the rows x columns block of obj at (i, j).
+    template <typename T>
+    Matrix<T> block(const Matrix<T> &obj, const std::size_t i, const std::size_t j, const std::size_t rows,
+        const std::size_t columns)
+    {
+        Matrix<T> res(rows, columns);
+        for (std::size_t r = 0u; r < rows; ++r)
+        {
+            for (std::size_t s = 0u; s < columns; ++s)
+            {
+                res(r, s) = obj(i + r, j + s);
+            }
+        }
+
+        return res;
+    }
+
+    // obj with its block at (i, j) replaced by value.
+    template <typename T>
+    Matrix<T> replaced(Matrix<T> obj, const std::size_t i, const std::size_t j, const Matrix<T> &value)
+    {
+        for (std::size_t r = 0u; r < value.size1(); ++r)
+        {
+            for (std::size_t s = 0u; s < value.size2(); ++s)
+            {
+                obj(i + r, j + s) = value(r, s);
+            }
+        }
+
+        return obj;
+    }
+
+    // max |lhs(i, j) - rhs(i, j)|, or NaN if any difference is NaN.
+    template <typename M>
+    double distance(const M &lhs, const M &rhs)
+    {
+        double res = 0.;
+        for (std::size_t i = 0u; i < lhs.size1(); ++i)
+        {
+            for (std::size_t j = 0u; j < lhs.size2(); ++j)
+            {
+                const double difference = double(std::abs(lhs(i, j) - rhs(i, j)));
+                res = std::isnan(difference) ? difference : std::max(res, difference);
+            }
+        }
+
+        return res;
+    }
+
+    // max |obj(i, j)|.
+    template <typename M>
+    double norm(const M &obj)
+    {
+        double res = 0.;
+        for (std::size_t i = 0u; i < obj.size1(); ++i)
+        {
+            for (std::size_t j = 0u; j < obj.size2(); ++j)
+            {
+                res = std::max(res, double(std::abs(obj(i, j))));
+            }
+        }
+
+        return res;
+    }
+
+    template <typename T>
+    Matrix<T> identity(const std::size_t n)
+    {
+        Matrix<T> res(n, n);
+        for (std::size_t i = 0u; i < n; ++i)
+        {
+            res(i, i) = T(1);
+        }
+
+        return res;
+    }
+}
+
+class Checker
+{
+private:
+    // Scaled residuals above this many units of roundoff fail.
+    static constexpr const double tolerance = 100.;
+
+    std::mt19937 generator;
+    std::string pass;
+    unsigned failures = 0u;
+
+    template <typename T>
+    T value(const T *);
+    template <typename T>
+    std::complex<T> value(const std::complex<T> *);
+
+public:
+    explicit Checker(unsigned);
+
+    void start(const std::string &);
+    unsigned failed() const;
+    void expect(bool, const std::string &);
+    template <typename T>
+    void expect_small(double, double, const std::string &);
+
+    template <typename T>
+    T random();
+    template <typename T>
+    Matrix<T> random(std::size_t, std::size_t);
+};
+
+constexpr const double Checker::tolerance;
+
+Checker::Checker(const unsigned seed) : generator(seed), pass()
+{
+}
+
+void Checker::start(const std::string &name)
+{
+    pass = name;
+}
+
+unsigned Checker::failed() const
+{
+    return failures;
+}
+
+void Checker::expect(const bool passed, const std::string &what)
+{
+    if (!passed)
+    {
+        std::cout << pass << ": " << what << " failed\n";
+        ++failures;
+    }
+}
+
+// residual <= tolerance * epsilon * scale, in the precision of T.
+template <typename T>
+void Checker::expect_small(const double residual, const double scale, const std::string &what)
+{
+    const double epsilon = double(std::numeric_limits<typename reference::Magnitude<T>::type>::epsilon());
+    const bool passed = residual <= tolerance * epsilon * scale;
+    expect(passed, what);
+    if (!passed)
+    {
+        std::cout << "    residual " << residual << ", bound " << tolerance * epsilon * scale << "\n";
+    }
+}
+
+template <typename T>
+T Checker::value(const T *)
+{
+    return T(std::uniform_real_distribution<double>(-1., 1.)(generator));
+}
+
+template <typename T>
+std::complex<T> Checker::value(const std::complex<T> *)
+{
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+    const T real(distribution(generator));
+
+    return std::complex<T>(real, T(distribution(generator)));
+}
+
+template <typename T>
+T Checker::random()
+{
+    return value(static_cast<const T *>(nullptr));
+}
+
+template <typename T>
+Matrix<T> Checker::random(const std::size_t rows, const std::size_t columns)
+{
+    Matrix<T> res(rows, columns);
+    for (std::size_t i = 0u; i < rows; ++i)
+    {
+        for (std::size_t j = 0u; j < columns; ++j)
+        {
+            res(i, j) = random<T>();
+        }
+    }
+
+    return res;
+}
+
+template <typename T>
+void check_lu(Checker &checker)
+{
+    using namespace reference;
+    for (const std::size_t n : {1u, 2u, 63u, 64u, 65u, 129u, 200u})
+    {
+        const std::string size = "LU " + std::to_string(n);
+        const Matrix<T> a = checker.random<T>(n, n), b = checker.random<T>(n, 3u);
+        const LU<T> lu(a);
+        const Matrix<T> x = lu.solve(b), inverse = lu.inverse();
+        checker.expect_small<T>(distance(product(a, x), b), double(n) * norm(a) * norm(x), size + " solve");
+        checker.expect_small<T>(distance(product(a, inverse), identity<T>(n)), double(n) * norm(a) * norm(inverse),
+            size + " inverse");
+        checker.expect(!lu.is_singular(), size + " regular");
+    }
+
+    // The rows of [2 -1 0; 1 3 2; 0 1 4], determinant 24, in reverse order.
+    const T values[3][3] = {{T(0), T(1), T(4)}, {T(1), T(3), T(2)}, {T(2), T(-1), T(0)}};
+    Matrix<T> a(3u, 3u);
+    for (std::size_t i = 0u; i < 3u; ++i)
+    {
+        for (std::size_t j = 0u; j < 3u; ++j)
+        {
+            a(i, j) = values[i][j];
+        }
+    }
+    checker.expect_small<T>(std::abs(LU<T>(a).determinant() - T(-24)), 24., "LU determinant");
+
+    // A zero row stays exactly zero through the elimination.
+    Matrix<T> singular = checker.random<T>(70u, 70u);
+    for (std::size_t j = 0u; j < 70u; ++j)
+    {
+        singular(3u, j) = T();
+    }
+    const LU<T> lu(singular);
+    checker.expect(lu.is_singular() && lu.determinant() == T(), "LU singular");
+    bool thrown = false;
+    try
+    {
+        lu.solve(checker.random<T>(70u, 1u));
+    }
+    catch (const std::domain_error &)
+    {
+        thrown = true;
+    }
+    checker.expect(thrown, "LU singular solve throws");
+}
+
+template <typename T>
+void check_cholesky(Checker &checker)
+{
+    using namespace reference;
+    for (const std::size_t n : {1u, 3u, 127u, 128u, 129u, 257u})
+    {
+        const std::string size = "Cholesky " + std::to_string(n);
+        const Matrix<T> c = checker.random<T>(n, n);
+        Matrix<T> a = product(adjoint(c), c);
+        for (std::size_t i = 0u; i < n; ++i)
+        {
+            a(i, i) += T(double(n));
+        }
+
+        const Cholesky<T> cholesky(a);
+        const Matrix<T> &l = cholesky.matrix();
+        checker.expect_small<T>(distance(product(l, adjoint(l)), a), double(n) * norm(a), size + " factor");
+        bool lower = true;
+        for (std::size_t i = 0u; i < n; ++i)
+        {
+            for (std::size_t j = i + 1u; j < n; ++j)
+            {
+                lower = lower && l(i, j) == T();
+            }
+        }
+        checker.expect(lower, size + " lower triangular");
+
+        const Matrix<T> b = checker.random<T>(n, 2u), x = cholesky.solve(b);
+        checker.expect_small<T>(distance(product(a, x), b), double(n) * norm(a) * norm(x), size + " solve");
+    }
+
+    bool thrown = false;
+    try
+    {
+        Cholesky<T> cholesky(Matrix<T>(3u, 3u, T(1)));
+    }
+    catch (const std::domain_error &)
+    {
+        thrown = true;
+    }
+    checker.expect(thrown, "Cholesky indefinite throws");
+}
+
+template <typename T>
+void check_qr(Checker &checker)
+{
+    using namespace reference;
+    const std::size_t shapes[][2] = {{1u, 1u}, {5u, 3u}, {3u, 5u}, {63u, 63u}, {65u, 63u}, {64u, 64u}, {63u, 65u},
+        {130u, 129u}, {129u, 130u}, {200u, 70u}};
+    for (const auto &shape : shapes)
+    {
+        const std::size_t m = shape[0], n = shape[1];
+        const std::string size = "QR " + std::to_string(m) + "x" + std::to_string(n);
+        const Matrix<T> a = checker.random<T>(m, n);
+        const QR<T> qr(a);
+        const Matrix<T> q = qr.q(), r = qr.r();
+        checker.expect_small<T>(distance(product(q, r), a), double(m) * norm(a), size + " factor");
+        checker.expect_small<T>(distance(product(adjoint(q), q), identity<T>(q.size2())), double(m),
+            size + " orthogonality");
+        bool upper = true;
+        for (std::size_t i = 0u; i < r.size1(); ++i)
+        {
+            for (std::size_t j = 0u; j < i; ++j)
+            {
+                upper = upper && r(i, j) == T();
+            }
+        }
+        checker.expect(upper, size + " upper triangular");
+
+        if (m >= n)
+        {
+            // The least squares residual is orthogonal to the columns of A.
+            const Matrix<T> b = checker.random<T>(m, 2u), x = qr.solve(b);
+            Matrix<T> residual = product(a, x);
+            residual -= b;
+            checker.expect_small<T>(norm(product(adjoint(a), residual)), double(m) * norm(a) * (norm(a) * norm(x) + norm(b)),
+                size + " least squares");
+        }
+    }
+
+    Matrix<T> deficient = checker.random<T>(80u, 70u);
+    for (std::size_t i = 0u; i < 80u; ++i)
+    {
+        deficient(i, 66u) = T();
+    }
+    bool thrown = false;
+    try
+    {
+        QR<T>(deficient).solve(checker.random<T>(80u, 1u));
+    }
+    catch (const std::domain_error &)
+    {
+        thrown = true;
+    }
+    checker.expect(thrown, "QR rank deficient solve throws");
+}
+
+// About density * rows * columns triplets, some of them repeated, and one
+// empty row and column.
+template <typename T>
+SparseMatrix<T> random_sparse(Checker &checker, const std::size_t rows, const std::size_t columns, const double density,
+    Matrix<T> &dense)
+{
+    SparseMatrixBuilder<T> builder(rows, columns);
+    dense = Matrix<T>(rows, columns);
+    const std::size_t count = std::size_t(density * double(rows * columns)) + 1u;
+    for (std::size_t k = 0u; k < count; ++k)
+    {
+        const std::size_t i = std::size_t(std::abs(checker.random<double>()) * double(rows)) % rows;
+        const std::size_t j = std::size_t(std::abs(checker.random<double>()) * double(columns)) % columns;
+        if (rows > 2u && i == rows / 2u)
+        {
+            continue;
+        }
+        if (columns > 2u && j == columns / 2u)
+        {
+            continue;
+        }
+        const T value = checker.random<T>();
+        builder.add(i, j, value);
+        dense(i, j) += value;
+        if (k % 7u == 0u)
+        {
+            builder.add(i, j, value);
+            dense(i, j) += value;
+        }
+    }
+
+    return builder.build();
+}
+
+template <typename T>
+void check_sparse(Checker &checker)
+{
+    using namespace reference;
+    const std::size_t shapes[][3] = {{1u, 1u, 1u}, {37u, 53u, 29u}, {200u, 150u, 90u}, {513u, 400u, 64u}};
+    for (const auto &shape : shapes)
+    {
+        const std::size_t m = shape[0], n = shape[1], p = shape[2];
+        const std::string size = "sparse " + std::to_string(m) + "x" + std::to_string(n);
+        Matrix<T> a_dense, b_dense;
+        const SparseMatrix<T> a = random_sparse(checker, m, n, 0.05, a_dense), b = random_sparse(checker, n, p, 0.05, b_dense);
+        checker.expect(distance(a.dense(), a_dense) == 0., size + " build");
+        checker.expect(distance(transpose(a).dense(), transposed(a_dense)) == 0., size + " transpose");
+
+        const Matrix<T> x = checker.random<T>(n, 1u), y = checker.random<T>(n, 5u);
+        std::vector<T> vector(n);
+        for (std::size_t i = 0u; i < n; ++i)
+        {
+            vector[i] = x(i, 0u);
+        }
+        const std::vector<T> spmv = a * vector;
+        Matrix<T> spmv_matrix(m, 1u);
+        for (std::size_t i = 0u; i < m; ++i)
+        {
+            spmv_matrix(i, 0u) = spmv[i];
+        }
+        checker.expect_small<T>(distance(spmv_matrix, product(a_dense, x)), double(n) * norm(a_dense) * norm(x), size + " SpMV");
+        checker.expect_small<T>(distance(a * y, product(a_dense, y)), double(n) * norm(a_dense) * norm(y), size + " SpMM");
+        checker.expect_small<T>(distance((a * b).dense(), product(a_dense, b_dense)), double(n) * norm(a_dense) * norm(b_dense),
+            size + " SpGEMM");
+    }
+}
+
+template <typename T, std::size_t R, std::size_t C, std::size_t K>
+void check_batch_multiply(Checker &checker, const std::size_t count)
+{
+    const std::string size = "batch " + std::to_string(count) + " of " + std::to_string(R) + "x" + std::to_string(C)
+        + "x" + std::to_string(K);
+    MatrixBatch<T, R, C> a(count);
+    MatrixBatch<T, C, K> b(count);
+    for (std::size_t k = 0u; k < count; ++k)
+    {
+        for (std::size_t i = 0u; i < R; ++i)
+        {
+            for (std::size_t j = 0u; j < C; ++j)
+            {
+                a(k, i, j) = checker.random<T>();
+            }
+        }
+        for (std::size_t i = 0u; i < C; ++i)
+        {
+            for (std::size_t j = 0u; j < K; ++j)
+            {
+                b(k, i, j) = checker.random<T>();
+            }
+        }
+    }
+
+    const MatrixBatch<T, R, K> c = a * b;
+    double error = 0.;
+    for (std::size_t k = 0u; k < count; ++k)
+    {
+        error = std::max(error, reference::distance(c.get(k), a.get(k) * b.get(k)));
+    }
+    checker.expect(c.size() == count, size + " multiply size");
+    checker.expect_small<T>(error, double(C), size + " multiply");
+}
+
+template <typename T, std::size_t N>
+void check_batch_solve(Checker &checker, const std::size_t count)
+{
+    const std::string size = "batch " + std::to_string(count) + " of " + std::to_string(N) + "x" + std::to_string(N);
+    MatrixBatch<T, N, N> a(count);
+    MatrixBatch<T, N, 2u> b(count);
+    for (std::size_t k = 0u; k < count; ++k)
+    {
+        for (std::size_t i = 0u; i < N; ++i)
+        {
+            for (std::size_t j = 0u; j < N; ++j)
+            {
+                a(k, i, j) = checker.random<T>();
+            }
+            b(k, i, 0u) = checker.random<T>();
+            b(k, i, 1u) = checker.random<T>();
+        }
+    }
+
+    const MatrixBatch<T, N, 2u> x = solve(a, b);
+    const MatrixBatch<T, N, N> inverse = ::inverse(a);
+    double solve_error = 0., inverse_error = 0.;
+    for (std::size_t k = 0u; k < count; ++k)
+    {
+        const Matrix<T, N, N> matrix = a.get(k), matrix_inverse = inverse.get(k);
+        const Matrix<T, N, 2u> solution = x.get(k);
+        const double scale = double(N) * reference::norm(matrix);
+        solve_error = std::max(solve_error, reference::distance(matrix * solution, b.get(k)) / (scale * reference::norm(solution)));
+        inverse_error = std::max(inverse_error, reference::distance(matrix * matrix_inverse, Matrix<T, N, N>::identity())
+            / (scale * reference::norm(matrix_inverse)));
+    }
+    checker.expect_small<T>(solve_error, 1., size + " solve");
+    checker.expect_small<T>(inverse_error, 1., size + " inverse");
+
+    // A singular matrix in the first block throws, whatever the blocks after
+    // it hold; the zero padding lanes of the last block do not.
+    MatrixBatch<T, N, N> singular(a);
+    for (std::size_t j = 0u; j < N; ++j)
+    {
+        singular(0u, N - 1u, j) = T();
+    }
+    bool thrown = false;
+    try
+    {
+        ::inverse(singular);
+    }
+    catch (const std::domain_error &)
+    {
+        thrown = true;
+    }
+    checker.expect(thrown, size + " singular inverse throws");
+}
+
+template <typename T>
+void check_batch(Checker &checker)
+{
+    const std::size_t lanes = MatrixBatch<T, 1u, 1u>::lanes;
+    for (const std::size_t count : {std::size_t(1u), lanes - 1u, lanes, lanes + 1u, 3u * lanes + 5u})
+    {
+        check_batch_multiply<T, 1u, 1u, 1u>(checker, count);
+        check_batch_multiply<T, 3u, 4u, 2u>(checker, count);
+        check_batch_multiply<T, 4u, 4u, 4u>(checker, count);
+        check_batch_solve<T, 1u>(checker, count);
+        check_batch_solve<T, 3u>(checker, count);
+        check_batch_solve<T, 4u>(checker, count);
+        check_batch_solve<T, 6u>(checker, count);
+    }
+}
+
+// Each dimension is one off a multiple of the micro-tile or of a cache
+// block of the kernel in use, so the product ends in partial slivers,
+// blocks and panels.
+template <typename T>
+void check_gemm(Checker &checker)
+{
+    using namespace reference;
+    const matrix_kernels::Kernel<T> &k = matrix_kernels::kernel<T>();
+    const std::size_t shapes[][3] = {{1u, 1u, 1u}, {k.mr - 1u, k.nr + 1u, 3u}, {k.mr + 1u, k.nr - 1u, k.kc + 1u},
+        {k.mc + 3u, 2u * k.nr + 5u, k.kc - 1u}, {2u * k.mc - 1u, 37u, 2u * k.kc + 3u}, {5u, k.nc + 1u, 9u}};
+    for (const auto &shape : shapes)
+    {
+        const std::size_t m = shape[0], n = shape[1], l = shape[2];
+        const std::string size = "gemm " + std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(l);
+        const Matrix<T> a = checker.random<T>(m, l), b = checker.random<T>(l, n);
+        const Matrix<T> c = a * b;
+        checker.expect(c.size1() == m && c.size2() == n, size + " shape");
+        checker.expect_small<T>(distance(c, product(a, b)), double(l) * norm(a) * norm(b), size);
+    }
+}
+
+// The micro-kernel kernel<T>() picked for this CPU against the portable
+// one, through the same blocked loops: whole tiles, a single kc step and
+// edge tiles, with C accumulated onto and alpha scaling A.
+template <typename T>
+void check_kernel(Checker &checker)
+{
+    using namespace reference;
+    const matrix_kernels::Kernel<T> &k = matrix_kernels::kernel<T>();
+    const matrix_kernels::Kernel<T> generic = matrix_kernels::make_kernel<T>(&matrix_kernels::generic_kernel<T, 4u, 4u>, 4u, 4u);
+    const std::string name = "kernel " + std::to_string(k.mr) + "x" + std::to_string(k.nr);
+    const std::size_t shapes[][3] = {{k.mr, k.nr, 1u}, {k.mr, k.nr, k.kc}, {2u * k.mr, 3u * k.nr, 2u * k.kc},
+        {3u * k.mr + 1u, 2u * k.nr - 1u, k.kc + 7u}};
+    for (const auto &shape : shapes)
+    {
+        const std::size_t m = shape[0], n = shape[1], l = shape[2];
+        const std::string size = name + " " + std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(l);
+        const Matrix<T> a = checker.random<T>(m, l), b = checker.random<T>(l, n);
+        const T alpha = checker.random<T>();
+        Matrix<T> c = checker.random<T>(m, n), expected(c);
+        matrix_kernels::serial_gemm(k, m, n, l, alpha, a.data(), std::ptrdiff_t(l), 1, false, b.data(), std::ptrdiff_t(n), 1, false,
+            c.data(), n);
+        matrix_kernels::serial_gemm(generic, m, n, l, alpha, a.data(), std::ptrdiff_t(l), 1, false, b.data(), std::ptrdiff_t(n), 1,
+            false, expected.data(), n);
+        checker.expect_small<T>(distance(c, expected), double(l) * norm(a) * norm(b) + norm(expected), size);
+    }
+}
+
+// Strassen-Winograd with a cutoff of 8: order 7 stays on gemm, even orders
+// recurse down to the cutoff and odd ones peel a row and a column on the
+// way. The scale is the normwise bound quoted in strassen.hpp.
+template <typename T>
+void check_strassen(Checker &checker)
+{
+    using namespace reference;
+    const std::size_t cutoff = matrix_kernels::strassen_cutoff(), order = 8u;
+    matrix_kernels::set_strassen_cutoff(order);
+    for (const std::size_t n : {7u, 16u, 64u, 65u, 128u, 129u})
+    {
+        const std::string size = "Strassen " + std::to_string(n);
+        const Matrix<T> a = checker.random<T>(n, n), b = checker.random<T>(n, n);
+        const Matrix<T> c = a * b;
+        const double bound = std::pow(double(n) / double(order), std::log2(18.)) * double(order * order + 6u * order) - 6. * double(n);
+        checker.expect_small<T>(distance(c, product(a, b)), std::max(bound, double(n)) * norm(a) * norm(b), size);
+    }
+    matrix_kernels::set_strassen_cutoff(cutoff);
+}
+
+// Destinations that are also operands of a product go through a
+// temporary, also when the product reshapes them; scalars around a product
+// fold into the alpha of its gemm, scalars inside it are evaluated first.
+template <typename T>
+void check_expressions(Checker &checker)
+{
+    using namespace reference;
+    const std::size_t n = 70u;
+    const Matrix<T> a = checker.random<T>(n, n), b = checker.random<T>(n, n), c = checker.random<T>(n, 20u);
+    const Matrix<T> ab = product(a, b);
+    const T alpha = checker.random<T>();
+    const double scale = 4. * double(n) * norm(a) * (norm(a) + norm(b) + norm(c));
+
+    Matrix<T> m(a);
+    m = m * m + m;
+    checker.expect_small<T>(distance(m, combination(T(1), product(a, a), T(1), a)), scale, "m = m * m + m");
+
+    m = a;
+    m *= b;
+    checker.expect_small<T>(distance(m, ab), scale, "m *= b");
+
+    m = a;
+    m = T(2) * m - m;
+    checker.expect(distance(m, a) == 0., "m = 2 * m - m");
+
+    m = a;
+    m += m * b;
+    checker.expect_small<T>(distance(m, combination(T(1), ab, T(1), a)), scale, "m += m * b");
+
+    m = a;
+    m = m * c;
+    checker.expect(m.size1() == n && m.size2() == c.size2(), "m = m * c shape");
+    checker.expect_small<T>(distance(m, product(a, c)), scale, "m = m * c");
+
+    m = checker.random<T>(n, n);
+    m = T(2) * (a * b) - (a * b) / T(4) - alpha * (a * b) + a;
+    checker.expect_small<T>(distance(m, combination(T(1.75) - alpha, ab, T(1), a)), scale, "folded coefficients");
+
+    m = -(alpha * (a * b));
+    checker.expect_small<T>(distance(m, combination(-alpha, ab, T(), a)), scale, "negated scaled product");
+
+    m = (alpha * a) * (b / T(2));
+    checker.expect_small<T>(distance(m, combination(alpha / T(2), ab, T(), a)), scale, "scaled operands");
+}
+
+// gemm(op_a, op_b, alpha, A, B, beta, C) for every pair of transpose
+// flags. With beta == 0, C starts as NaN and must not be read; beta == 1
+// and a random beta update a window of a larger matrix. Operands whose
+// storage overlaps C must be copied before C is written.
+template <typename T>
+void check_view_gemm(Checker &checker)
+{
+    using namespace reference;
+    const Transpose ops[] = {NO_TRANSPOSE, TRANSPOSE, CONJUGATE_TRANSPOSE};
+    const char *const names[] = {"N", "T", "C"};
+    const std::size_t m = 37u, n = 29u, l = 41u;
+    const T nan = T(std::numeric_limits<typename Magnitude<T>::type>::quiet_NaN());
+    for (const Transpose op_a : ops)
+    {
+        for (const Transpose op_b : ops)
+        {
+            const std::string flags = std::string("view gemm ") + names[op_a] + names[op_b];
+            const Matrix<T> a = op_a == NO_TRANSPOSE ? checker.random<T>(m, l) : checker.random<T>(l, m);
+            const Matrix<T> b = op_b == NO_TRANSPOSE ? checker.random<T>(l, n) : checker.random<T>(n, l);
+            const Matrix<T> ab = product(apply(op_a, a), apply(op_b, b));
+            const T alpha = checker.random<T>(), beta = checker.random<T>();
+            const double scale = double(l) * norm(a) * norm(b) + 1.;
+
+            Matrix<T> c(m, n, nan);
+            gemm(op_a, op_b, alpha, a, b, T(), c);
+            checker.expect_small<T>(distance(c, combination(alpha, ab, T(), ab)), scale, flags + " beta 0");
+
+            const Matrix<T> frame = checker.random<T>(m + 3u, n + 4u);
+            for (const T factor : {T(1), beta})
+            {
+                Matrix<T> target(frame);
+                gemm(op_a, op_b, alpha, a, b, factor, target.submatrix(1u, 2u, m, n));
+                const Matrix<T> expected = replaced(frame, 1u, 2u, combination(alpha, ab, factor, block(frame, 1u, 2u, m, n)));
+                checker.expect_small<T>(distance(target, expected), scale, flags + (factor == T(1) ? " beta 1" : " beta"));
+            }
+        }
+    }
+
+    const T alpha = checker.random<T>(), beta = checker.random<T>();
+    const Matrix<T> frame = checker.random<T>(80u, 80u), a = checker.random<T>(m, l), b = checker.random<T>(l, n);
+    const double scale = double(l) * norm(frame) * (norm(frame) + norm(a) + norm(b)) + 1.;
+
+    Matrix<T> s(frame);
+    gemm(NO_TRANSPOSE, NO_TRANSPOSE, alpha, s.submatrix(0u, 0u, m, l), b, beta, s.submatrix(5u, 7u, m, n));
+    Matrix<T> expected = replaced(frame, 5u, 7u,
+        combination(alpha, product(block(frame, 0u, 0u, m, l), b), beta, block(frame, 5u, 7u, m, n)));
+    checker.expect_small<T>(distance(s, expected), scale, "view gemm A overlaps C");
+
+    s = frame;
+    gemm(NO_TRANSPOSE, CONJUGATE_TRANSPOSE, alpha, a, s.submatrix(20u, 30u, n, l), beta, s.submatrix(10u, 40u, m, n));
+    expected = replaced(frame, 10u, 40u,
+        combination(alpha, product(a, adjoint(block(frame, 20u, 30u, n, l))), beta, block(frame, 10u, 40u, m, n)));
+    checker.expect_small<T>(distance(s, expected), scale, "view gemm B overlaps C");
+
+    s = frame;
+    gemm(TRANSPOSE, NO_TRANSPOSE, alpha, s, s, T(), s);
+    checker.expect_small<T>(distance(s, combination(alpha, product(transposed(frame), frame), T(), frame)), scale,
+        "view gemm A and B are C");
+}
+
+// Views write through to their window and nowhere else: scaling and a row
+// operation on a strided submatrix, a column, the diagonal of a submatrix
+// and a product assigned to a submatrix. Products read views in place and
+// must match the same product of copied blocks.
+template <typename T>
+void check_views(Checker &checker)
+{
+    using namespace reference;
+    const std::size_t m = 37u, n = 29u, l = 41u;
+    const Matrix<T> frame = checker.random<T>(45u, 50u), other = checker.random<T>(45u, 30u);
+    const T alpha = checker.random<T>() + T(2);
+    const double scale = 4. * double(l) * (norm(frame) + 1.) * (norm(other) + 1.) * std::abs(alpha);
+
+    Matrix<T> s(frame);
+    s.submatrix(3u, 5u, 17u, 23u) *= alpha;
+    const Matrix<T> window = block(frame, 3u, 5u, 17u, 23u);
+    checker.expect_small<T>(distance(s, replaced(frame, 3u, 5u, combination(alpha, window, T(), window))), scale,
+        "submatrix *=");
+
+    s = frame;
+    s.submatrix(3u, 5u, 17u, 23u).row_addition(2u, alpha, 9u);
+    Matrix<T> expected = window;
+    for (std::size_t j = 0u; j < expected.size2(); ++j)
+    {
+        expected(2u, j) += alpha * window(9u, j);
+    }
+    checker.expect_small<T>(distance(s, replaced(frame, 3u, 5u, expected)), scale, "submatrix row_addition");
+
+    s = frame;
+    s.column(7u) *= alpha;
+    const Matrix<T> column = block(frame, 0u, 7u, frame.size1(), 1u);
+    checker.expect_small<T>(distance(s, replaced(frame, 0u, 7u, combination(alpha, column, T(), column))), scale, "column *=");
+
+    s = frame;
+    s.submatrix(2u, 4u, 10u, 12u).diagonal() /= alpha;
+    expected = frame;
+    for (std::size_t k = 0u; k < 10u; ++k)
+    {
+        expected(2u + k, 4u + k) /= alpha;
+    }
+    checker.expect_small<T>(distance(s, expected), scale, "submatrix diagonal /=");
+
+    s = frame;
+    const Matrix<T> a = checker.random<T>(m, l), b = checker.random<T>(l, n);
+    s.submatrix(5u, 20u, m, n) = a * b;
+    checker.expect_small<T>(distance(s, replaced(frame, 5u, 20u, product(a, b))), scale, "submatrix = a * b");
+
+    const Matrix<T> c = frame.submatrix(1u, 2u, m, l) * other.submatrix(3u, 0u, l, n);
+    checker.expect_small<T>(distance(c, product(block(frame, 1u, 2u, m, l), block(other, 3u, 0u, l, n))), scale,
+        "product of submatrices");
+
+    const Matrix<T> outer = frame.column(3u) * other.row(5u);
+    checker.expect_small<T>(distance(outer, product(block(frame, 0u, 3u, frame.size1(), 1u), block(other, 5u, 0u, 1u, other.size2()))),
+        scale, "column * row");
+}
+
+// Square matrices are transposed in place by swapping mirrored blocks of
+// transpose_kernel().block, rectangular n x (n + 5) ones by following
+// permutation cycles, and transposing back must restore the original.
+// Orders sit around that block and around the 4 and 8 register tiles of
+// the copying transpose, which is checked as well.
+template <typename T>
+void check_transpose(Checker &checker)
+{
+    using namespace reference;
+    const matrix_kernels::TransposeKernel<T> &k = matrix_kernels::transpose_kernel<T>();
+    for (const std::size_t n : {std::size_t(1u), std::size_t(3u), std::size_t(4u), std::size_t(5u), std::size_t(7u),
+        std::size_t(8u), std::size_t(9u), std::size_t(17u), k.block - 1u, k.block, k.block + 1u, 2u * k.block + 3u})
+    {
+        const std::string size = "transpose " + std::to_string(n);
+        const Matrix<T> a = checker.random<T>(n, n);
+        Matrix<T> b(a);
+        b.transpose();
+        checker.expect(distance(b, transposed(a)) == 0., size + " in place");
+        checker.expect(distance(transpose(a), transposed(a)) == 0., size + " copy");
+    }
+
+    for (const std::size_t n : {std::size_t(1u), std::size_t(3u), k.tile + 1u, std::size_t(31u), k.block + 2u})
+    {
+        const std::string size = "transpose " + std::to_string(n) + "x" + std::to_string(n + 5u);
+        const Matrix<T> a = checker.random<T>(n, n + 5u);
+        Matrix<T> b(a);
+        b.transpose();
+        checker.expect(b.size1() == n + 5u && b.size2() == n && distance(b, transposed(a)) == 0., size + " in place");
+        checker.expect(distance(transpose(a), transposed(a)) == 0., size + " copy");
+        b.transpose();
+        checker.expect(b.size1() == n && b.size2() == n + 5u && distance(b, a) == 0., size + " back");
+    }
+}
+
+// Fixed-size products and transposes are constant expressions.
+constexpr Matrix<double, 2u, 3u> fixed_lhs(1., 2., 3., 4., 5., 6.);
+constexpr Matrix<double, 3u, 2u> fixed_rhs(7., 8., 9., 10., 11., 12.);
+static_assert((fixed_lhs * fixed_rhs)(0u, 1u) == 64. && (fixed_lhs * fixed_rhs)(1u, 0u) == 139., "constexpr fixed product");
+static_assert(transpose(fixed_lhs)(2u, 1u) == 6. && transpose(fixed_lhs)(0u, 1u) == 4., "constexpr fixed transpose");
+
+// Matrix<T, R, C> converts to and from Matrix<T> element by element and
+// joins lazy expressions through view(); converting a Matrix<T> of any
+// other shape throws.
+template <typename T>
+void check_fixed(Checker &checker)
+{
+    const Matrix<T> dynamic = checker.random<T>(3u, 4u);
+    const Matrix<T, 3u, 4u> fixed(dynamic);
+    bool equal = true;
+    for (std::size_t i = 0u; i < 3u; ++i)
+    {
+        for (std::size_t j = 0u; j < 4u; ++j)
+        {
+            equal = equal && fixed(i, j) == dynamic(i, j);
+        }
+    }
+    checker.expect(equal, "fixed from dynamic");
+
+    const Matrix<T> back = fixed;
+    checker.expect(back.size1() == 3u && back.size2() == 4u && reference::distance(back, dynamic) == 0., "fixed to dynamic");
+    const Matrix<T> twice = fixed.view() + dynamic;
+    checker.expect(reference::distance(twice, reference::combination(T(2), dynamic, T(), dynamic)) == 0., "fixed view in expression");
+
+    const std::size_t shapes[][2] = {{4u, 3u}, {3u, 5u}, {2u, 4u}, {0u, 0u}};
+    for (const auto &shape : shapes)
+    {
+        bool thrown = false;
+        try
+        {
+            const Matrix<T, 3u, 4u> wrong(Matrix<T>(shape[0], shape[1]));
+        }
+        catch (const std::domain_error &)
+        {
+            thrown = true;
+        }
+        checker.expect(thrown, "fixed from " + std::to_string(shape[0]) + "x" + std::to_string(shape[1]) + " throws");
+    }
+}
+
+void check_all(Checker &checker)
+{
+    try
+    {
+        check_gemm<double>(checker);
+        check_gemm<float>(checker);
+        check_gemm<std::complex<double>>(checker);
+        check_kernel<double>(checker);
+        check_kernel<float>(checker);
+        check_strassen<double>(checker);
+        check_strassen<std::complex<double>>(checker);
+        check_expressions<double>(checker);
+        check_expressions<std::complex<double>>(checker);
+        check_view_gemm<double>(checker);
+        check_view_gemm<std::complex<double>>(checker);
+        check_views<double>(checker);
+        check_views<std::complex<double>>(checker);
+        check_transpose<double>(checker);
+        check_transpose<float>(checker);
+        check_transpose<std::complex<double>>(checker);
+        check_fixed<double>(checker);
+        check_fixed<float>(checker);
+        check_lu<double>(checker);
+        check_lu<float>(checker);
+        check_lu<std::complex<double>>(checker);
+        check_cholesky<double>(checker);
+        check_cholesky<std::complex<double>>(checker);
+        check_qr<double>(checker);
+        check_qr<std::complex<double>>(checker);
+        check_sparse<double>(checker);
+        check_sparse<std::complex<double>>(checker);
+        check_batch<double>(checker);
+        check_batch<float>(checker);
+    }
+    catch (const std::exception &except)
+    {
+        checker.expect(false, std::string("unexpected exception '") + except.what() + "'");
+    }
+}
+
+int main()
+{
+    Checker checker(1u);
+    const std::size_t cutoff = matrix_kernels::parallel_cutoff();
+    matrix_kernels::set_parallel_cutoff(1u);
+    for (const std::size_t threads : {1u, 2u, 3u, 8u})
+    {
+        matrix_kernels::set_threads(threads);
+        checker.start(std::to_string(threads) + (threads == 1u ? " thread" : " threads"));
+        check_all(checker);
+    }
+    matrix_kernels::set_parallel_cutoff(cutoff);
+
+    if (checker.failed())
+    {
+        std::cout << checker.failed() << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+
+    return 0;
+}
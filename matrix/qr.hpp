@@ -0,0 +1,302 @@
+#ifndef __QR_HPP__
+#define __QR_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "./matrix_complex.hpp"
+#include "./task_graph.hpp"
+
+// A = Q * R by Householder reflections, blocked in panels of block_size
+// columns. A panel is factored column by column; its reflectors
+// H_i = I - tau_i * v_i * v_i^H are then accumulated in compact WY form,
+// H_1 * ... * H_b = I - V * T * V^H with T upper triangular, so that the
+// rest of the matrix is updated with three products instead of b rank-1
+// updates. The panel and the update of every column tile are tasks on a
+// TaskGraph: panel k + 1 starts as soon as its own tile has been updated,
+// while the updates of the other tiles by panel k are still running.
+//
+// R is stored on and above the diagonal, the v_i (unit first element not
+// stored) below it.
+template <typename T>
+class QR
+{
+public:
+    typedef Matrix<T> matrix_type;
+    typedef typename matrix_type::value_type value_type;
+    typedef typename matrix_type::size_type size_type;
+    typedef typename std::decay<decltype(std::abs(value_type()))>::type magnitude_type;
+
+    static constexpr const size_type block_size = 64u;
+
+private:
+    matrix_type factors;
+    std::vector<matrix_type> reflectors;
+    std::vector<matrix_type> triangles;
+
+    void factor_panel(size_type);
+    void apply(size_type, bool, value_type *, size_type, size_type) const;
+
+public:
+    explicit QR(matrix_type);
+
+    const matrix_type &matrix() const;
+    matrix_type q() const;
+    matrix_type r() const;
+    matrix_type solve(const matrix_type &) const;
+};
+
+template <typename T>
+constexpr const typename QR<T>::size_type QR<T>::block_size;
+
+template <typename T>
+QR<T>::QR(matrix_type obj) : factors(std::move(obj)), reflectors(), triangles()
+{
+    const size_type m = factors.size1(), n = factors.size2(), lda = factors.stride();
+    const size_type panels = (std::min(m, n) + block_size - 1u) / block_size, tiles = (n + block_size - 1u) / block_size;
+    reflectors.resize(panels);
+    triangles.resize(panels);
+
+    value_type *const a = factors.data();
+    TaskGraph graph;
+    for (size_type p = 0u; p < panels; ++p)
+    {
+        graph.add([this, p]() { factor_panel(p); }, {}, {p}, 2);
+        for (size_type j = p + 1u; j < tiles; ++j)
+        {
+            const size_type k = p * block_size, first = j * block_size, width = std::min(block_size, n - first);
+            graph.add([=]() { apply(p, true, a + k * lda + first, width, lda); }, {p}, {j}, j == p + 1u ? 1 : 0);
+        }
+    }
+    graph.run(tiles > 1u ? matrix_kernels::pool() : nullptr);
+}
+
+// Reflectors for the columns of panel p, applied at once to the rest of the
+// panel's column tile; then V and T.
+template <typename T>
+void QR<T>::factor_panel(const size_type p)
+{
+    const size_type m = factors.size1(), n = factors.size2(), lda = factors.stride();
+    const size_type k = p * block_size, b = std::min(block_size, std::min(m, n) - k);
+    const size_type end = std::min(n, k + block_size), rows = m - k;
+    value_type *const a = factors.data();
+
+    std::vector<value_type> taus(b), w(end);
+    for (size_type j = k; j < k + b; ++j)
+    {
+        value_type *const pivot_row = a + j * lda;
+        const value_type alpha = pivot_row[j];
+        magnitude_type tail = magnitude_type();
+        for (size_type i = j + 1u; i < m; ++i)
+        {
+            tail += std::norm(a[i * lda + j]);
+        }
+
+        value_type tau = value_type();
+        if (tail != magnitude_type() || std::imag(alpha) != magnitude_type())
+        {
+            const magnitude_type beta = -std::copysign(std::sqrt(std::norm(alpha) + tail), std::real(alpha));
+            tau = (beta - alpha) / beta;
+            const value_type scale = value_type(1) / (alpha - beta);
+            for (size_type i = j + 1u; i < m; ++i)
+            {
+                a[i * lda + j] *= scale;
+            }
+            pivot_row[j] = beta;
+        }
+        taus[j - k] = tau;
+
+        // Columns j + 1 to end -= conj(tau) * v * (v^H * columns).
+        const value_type factor = matrix_kernels::conjugate(tau);
+        std::copy(pivot_row + j + 1u, pivot_row + end, w.begin() + j + 1u);
+        for (size_type i = j + 1u; i < m; ++i)
+        {
+            const value_type *const row = a + i * lda;
+            const value_type v = matrix_kernels::conjugate(row[j]);
+            for (size_type c = j + 1u; c < end; ++c)
+            {
+                w[c] += v * row[c];
+            }
+        }
+        for (size_type c = j + 1u; c < end; ++c)
+        {
+            pivot_row[c] -= factor * w[c];
+        }
+        for (size_type i = j + 1u; i < m; ++i)
+        {
+            value_type *const row = a + i * lda;
+            const value_type v = factor * row[j];
+            for (size_type c = j + 1u; c < end; ++c)
+            {
+                row[c] -= v * w[c];
+            }
+        }
+    }
+
+    matrix_type &v = reflectors[p];
+    v.zero(rows, b);
+    for (size_type i = 0u; i < rows; ++i)
+    {
+        for (size_type c = 0u; c < b && c <= i; ++c)
+        {
+            v(i, c) = i == c ? value_type(1) : a[(k + i) * lda + k + c];
+        }
+    }
+
+    // T(0:i, i) = -tau_i * T(0:i, 0:i) * V(:, 0:i)^H * v_i.
+    matrix_type &t = triangles[p];
+    t.zero(b, b);
+    std::vector<value_type> z(b);
+    for (size_type i = 0u; i < b; ++i)
+    {
+        std::fill(z.begin(), z.end(), value_type());
+        for (size_type r = i; r < rows; ++r)
+        {
+            const value_type x = v(r, i);
+            for (size_type c = 0u; c < i; ++c)
+            {
+                z[c] += matrix_kernels::conjugate(v(r, c)) * x;
+            }
+        }
+        for (size_type r = 0u; r < i; ++r)
+        {
+            value_type s = value_type();
+            for (size_type c = r; c < i; ++c)
+            {
+                s += t(r, c) * z[c];
+            }
+            t(r, i) = -taus[i] * s;
+        }
+        t(i, i) = taus[i];
+    }
+}
+
+// C = (I - V * T * V^H) * C, or with T^H when adjoint is set, for the rows of
+// C from the first row of panel p down; c points at that row. Runs on the
+// calling thread.
+template <typename T>
+void QR<T>::apply(const size_type p, const bool adjoint, value_type *const c, const size_type columns, const size_type ldc) const
+{
+    const matrix_type &v = reflectors[p], &t = triangles[p];
+    const size_type rows = v.size1(), b = v.size2();
+    if (!rows || !b || !columns)
+    {
+        return;
+    }
+
+    const matrix_kernels::Kernel<value_type> &k = matrix_kernels::kernel<value_type>();
+    const std::ptrdiff_t ldv = std::ptrdiff_t(v.stride()), ldt = std::ptrdiff_t(t.stride());
+    matrix_type w(b, columns), y(b, columns);
+    matrix_kernels::serial_gemm(k, b, columns, rows, value_type(1),
+        v.data(), 1, ldv, true, c, std::ptrdiff_t(ldc), 1, false, w.data(), w.stride());
+    if (adjoint)
+    {
+        matrix_kernels::serial_gemm(k, b, columns, b, value_type(1),
+            t.data(), 1, ldt, true, w.data(), std::ptrdiff_t(w.stride()), 1, false, y.data(), y.stride());
+    }
+    else
+    {
+        matrix_kernels::serial_gemm(k, b, columns, b, value_type(1),
+            t.data(), ldt, 1, false, w.data(), std::ptrdiff_t(w.stride()), 1, false, y.data(), y.stride());
+    }
+    matrix_kernels::serial_gemm(k, rows, columns, b, value_type(-1),
+        v.data(), ldv, 1, false, y.data(), std::ptrdiff_t(y.stride()), 1, false, c, ldc);
+}
+
+template <typename T>
+const typename QR<T>::matrix_type &QR<T>::matrix() const
+{
+    return factors;
+}
+
+// The first min(m, n) columns of Q.
+template <typename T>
+typename QR<T>::matrix_type QR<T>::q() const
+{
+    const size_type m = factors.size1(), order = std::min(m, factors.size2());
+    matrix_type result(m, order);
+    for (size_type i = 0u; i < order; ++i)
+    {
+        result(i, i) = value_type(1);
+    }
+    for (size_type p = reflectors.size(); p-- > 0u;)
+    {
+        apply(p, false, result.data() + p * block_size * result.stride(), order, result.stride());
+    }
+
+    return result;
+}
+
+// The upper trapezoidal min(m, n) x n factor.
+template <typename T>
+typename QR<T>::matrix_type QR<T>::r() const
+{
+    const size_type n = factors.size2(), order = std::min(factors.size1(), n);
+    matrix_type result(order, n);
+    for (size_type i = 0u; i < order; ++i)
+    {
+        std::copy(factors.data() + i * factors.stride() + i, factors.data() + i * factors.stride() + n,
+            result.data() + i * result.stride() + i);
+    }
+
+    return result;
+}
+
+// The least squares solution of A * X = B for m >= n and full rank:
+// R * X = (Q^H * B)(0:n).
+template <typename T>
+typename QR<T>::matrix_type QR<T>::solve(const matrix_type &rhs) const
+{
+    const size_type m = factors.size1(), n = factors.size2(), lda = factors.stride();
+    if (rhs.size1() != m)
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+    if (m < n)
+    {
+        throw std::domain_error("Matrix has more columns than rows");
+    }
+    for (size_type i = 0u; i < n; ++i)
+    {
+        if (factors(i, i) == value_type())
+        {
+            throw std::domain_error("Matrix is rank deficient");
+        }
+    }
+
+    matrix_type y(rhs);
+    for (size_type p = 0u; p < reflectors.size(); ++p)
+    {
+        apply(p, true, y.data() + p * block_size * y.stride(), y.size2(), y.stride());
+    }
+
+    matrix_type result = y.submatrix(0u, 0u, n, y.size2());
+    const size_type columns = result.size2(), ldx = result.stride();
+    const value_type *const a = factors.data();
+    value_type *const x = result.data();
+    for (size_type end = n; end > 0u;)
+    {
+        const size_type k = (end - 1u) / block_size * block_size;
+        for (size_type i = end; i-- > k;)
+        {
+            for (size_type p = i + 1u; p < end; ++p)
+            {
+                result.row_addition(i, -a[i * lda + p], p);
+            }
+            result.row_multiplication(value_type(1) / a[i * lda + i], i);
+        }
+        matrix_kernels::gemm(k, columns, end - k, value_type(-1),
+            a + k, lda, 1, x + k * ldx, ldx, 1, x, ldx);
+        end = k;
+    }
+
+    return result;
+}
+
+#endif
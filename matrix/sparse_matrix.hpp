@@ -0,0 +1,502 @@
+#ifndef __SPARSE_MATRIX_HPP__
+#define __SPARSE_MATRIX_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "./matrix_complex.hpp"
+
+template <typename T>
+class SparseMatrixBuilder;
+
+// Compressed sparse rows: the nonzeros of row i are values[offsets[i]] to
+// values[offsets[i + 1] - 1], with their columns, in ascending order, in
+// indices. Storage and every operation scale with the number of nonzeros
+// rather than with rows * columns. transpose() gives the compressed sparse
+// column form: the CSR arrays of A^T are the CSC arrays of A.
+template <typename T>
+class SparseMatrix
+{
+public:
+    typedef Matrix<T> matrix_type;
+    typedef typename matrix_type::value_type value_type;
+    typedef typename matrix_type::size_type size_type;
+
+private:
+    size_type rows = 0u;
+    size_type columns = 0u;
+    std::vector<size_type> offsets;
+    std::vector<size_type> indices;
+    std::vector<value_type> values;
+
+    size_type first_row(size_type) const;
+    template <typename Function>
+    void for_rows(double, const Function &) const;
+
+public:
+    SparseMatrix();
+    SparseMatrix(size_type, size_type);
+    explicit SparseMatrix(const matrix_type &);
+
+    size_type size1() const;
+    size_type size2() const;
+    size_type nonzeros() const;
+    const std::vector<size_type> &row_offsets() const;
+    const std::vector<size_type> &column_indices() const;
+    const std::vector<value_type> &elements() const;
+    value_type operator ()(size_type, size_type) const;
+
+    matrix_type dense() const;
+    void multiply(const value_type *, size_type, size_type, value_type *, size_type) const;
+
+    template <typename S>
+    friend SparseMatrix<S> transpose(const SparseMatrix<S> &);
+    template <typename S>
+    friend Matrix<S> operator *(const SparseMatrix<S> &, const Matrix<S> &);
+    template <typename S>
+    friend std::vector<typename SparseMatrix<S>::value_type> operator *(const SparseMatrix<S> &,
+        const std::vector<typename SparseMatrix<S>::value_type> &);
+    template <typename S>
+    friend SparseMatrix<S> operator *(const SparseMatrix<S> &, const SparseMatrix<S> &);
+
+    friend class SparseMatrixBuilder<T>;
+};
+
+// Collects (row, column, value) triplets in any order, one at a time, and
+// turns them into a SparseMatrix in O(nonzeros + rows + columns): a stable
+// counting sort by column and then by row leaves every row sorted, after
+// which duplicates are summed.
+template <typename T>
+class SparseMatrixBuilder
+{
+public:
+    typedef SparseMatrix<T> sparse_type;
+    typedef typename sparse_type::value_type value_type;
+    typedef typename sparse_type::size_type size_type;
+
+private:
+    size_type rows;
+    size_type columns;
+    std::vector<size_type> row_indices;
+    std::vector<size_type> column_indices;
+    std::vector<value_type> values;
+
+public:
+    SparseMatrixBuilder(size_type, size_type);
+
+    void reserve(size_type);
+    void add(size_type, size_type, const value_type &);
+    sparse_type build();
+};
+
+template <typename T>
+SparseMatrix<T> transpose(const SparseMatrix<T> &);
+template <typename T>
+Matrix<T> operator *(const SparseMatrix<T> &, const Matrix<T> &);
+template <typename T>
+std::vector<typename SparseMatrix<T>::value_type> operator *(const SparseMatrix<T> &,
+    const std::vector<typename SparseMatrix<T>::value_type> &);
+template <typename T>
+SparseMatrix<T> operator *(const SparseMatrix<T> &, const SparseMatrix<T> &);
+
+template <typename T>
+SparseMatrix<T>::SparseMatrix() : offsets(1u), indices(), values()
+{
+}
+
+template <typename T>
+SparseMatrix<T>::SparseMatrix(const size_type row, const size_type column) : rows(row), columns(column),
+    offsets(row + 1u), indices(), values()
+{
+}
+
+// Keeps the cells that are not exactly zero.
+template <typename T>
+SparseMatrix<T>::SparseMatrix(const matrix_type &obj) : SparseMatrix(obj.size1(), obj.size2())
+{
+    for (size_type i = 0u; i < rows; ++i)
+    {
+        const value_type *const row = obj.data() + i * obj.stride();
+        for (size_type j = 0u; j < columns; ++j)
+        {
+            if (row[j] != value_type())
+            {
+                indices.push_back(j);
+                values.push_back(row[j]);
+            }
+        }
+        offsets[i + 1u] = values.size();
+    }
+}
+
+// The first row starting at or after nonzero number position.
+template <typename T>
+typename SparseMatrix<T>::size_type SparseMatrix<T>::first_row(const size_type position) const
+{
+    return size_type(std::lower_bound(offsets.begin(), offsets.end(), position) - offsets.begin());
+}
+
+// Calls function(first, last) on ranges of rows covering the matrix. When
+// work, in multiply-adds, reaches parallel_cutoff() there is one range per
+// thread, each holding about the same number of nonzeros, and the ranges run
+// on the gemm pool.
+template <typename T>
+template <typename Function>
+void SparseMatrix<T>::for_rows(const double work, const Function &function) const
+{
+    ThreadPool *const workers = work >= double(matrix_kernels::parallel_cutoff()) ? matrix_kernels::pool() : nullptr;
+    if (!workers || rows < 2u)
+    {
+        function(size_type(0u), rows);
+        return;
+    }
+
+    const size_type count = std::min<size_type>(workers->size() + 1u, rows), total = values.size();
+    workers->run(count, [&](const std::size_t part)
+    {
+        const size_type first = part ? std::min(first_row(total * part / count), rows) : 0u;
+        const size_type last = part + 1u < count ? std::min(first_row(total * (part + 1u) / count), rows) : rows;
+        function(first, last);
+    });
+}
+
+template <typename T>
+typename SparseMatrix<T>::size_type SparseMatrix<T>::size1() const
+{
+    return rows;
+}
+
+template <typename T>
+typename SparseMatrix<T>::size_type SparseMatrix<T>::size2() const
+{
+    return columns;
+}
+
+template <typename T>
+typename SparseMatrix<T>::size_type SparseMatrix<T>::nonzeros() const
+{
+    return values.size();
+}
+
+template <typename T>
+const std::vector<typename SparseMatrix<T>::size_type> &SparseMatrix<T>::row_offsets() const
+{
+    return offsets;
+}
+
+template <typename T>
+const std::vector<typename SparseMatrix<T>::size_type> &SparseMatrix<T>::column_indices() const
+{
+    return indices;
+}
+
+template <typename T>
+const std::vector<typename SparseMatrix<T>::value_type> &SparseMatrix<T>::elements() const
+{
+    return values;
+}
+
+// Binary search in row i.
+template <typename T>
+typename SparseMatrix<T>::value_type SparseMatrix<T>::operator ()(const size_type i, const size_type j) const
+{
+    const auto first = indices.begin() + offsets[i], last = indices.begin() + offsets[i + 1u];
+    const auto found = std::lower_bound(first, last, j);
+
+    return found != last && *found == j ? values[found - indices.begin()] : value_type();
+}
+
+template <typename T>
+typename SparseMatrix<T>::matrix_type SparseMatrix<T>::dense() const
+{
+    matrix_type result(rows, columns);
+    for (size_type i = 0u; i < rows; ++i)
+    {
+        value_type *const row = result.data() + i * result.stride();
+        for (size_type p = offsets[i]; p < offsets[i + 1u]; ++p)
+        {
+            row[indices[p]] = values[p];
+        }
+    }
+
+    return result;
+}
+
+// Y[rows x n] += A * X[columns x n] for row-major X and Y; every nonzero
+// A(i, k) adds a multiple of row k of X to row i of Y.
+template <typename T>
+void SparseMatrix<T>::multiply(const value_type *const x, const size_type ldx, const size_type n,
+    value_type *const y, const size_type ldy) const
+{
+    if (!n)
+    {
+        return;
+    }
+
+    for_rows(double(values.size()) * double(n), [&](const size_type first, const size_type last)
+    {
+        for (size_type i = first; i < last; ++i)
+        {
+            value_type *const target = y + i * ldy;
+            if (n == 1u)
+            {
+                value_type sum = value_type();
+                for (size_type p = offsets[i]; p < offsets[i + 1u]; ++p)
+                {
+                    sum += values[p] * x[indices[p] * ldx];
+                }
+                *target += sum;
+                continue;
+            }
+
+            for (size_type p = offsets[i]; p < offsets[i + 1u]; ++p)
+            {
+                const value_type v = values[p];
+                const value_type *const source = x + indices[p] * ldx;
+                for (size_type c = 0u; c < n; ++c)
+                {
+                    target[c] += v * source[c];
+                }
+            }
+        }
+    });
+}
+
+// Counting sort by column; rows are visited in order, so the rows of every
+// column come out sorted.
+template <typename T>
+SparseMatrix<T> transpose(const SparseMatrix<T> &obj)
+{
+    typedef typename SparseMatrix<T>::size_type size_type;
+
+    SparseMatrix<T> result(obj.columns, obj.rows);
+    for (const size_type j : obj.indices)
+    {
+        ++result.offsets[j + 1u];
+    }
+    std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+
+    result.indices.resize(obj.values.size());
+    result.values.resize(obj.values.size());
+    std::vector<size_type> next(result.offsets.begin(), result.offsets.end() - 1);
+    for (size_type i = 0u; i < obj.rows; ++i)
+    {
+        for (size_type p = obj.offsets[i]; p < obj.offsets[i + 1u]; ++p)
+        {
+            const size_type position = next[obj.indices[p]]++;
+            result.indices[position] = i;
+            result.values[position] = obj.values[p];
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+Matrix<T> operator *(const SparseMatrix<T> &lhs, const Matrix<T> &rhs)
+{
+    if (lhs.columns != rhs.size1())
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    Matrix<T> result(lhs.rows, rhs.size2());
+    lhs.multiply(rhs.data(), rhs.stride(), rhs.size2(), result.data(), result.stride());
+
+    return result;
+}
+
+template <typename T>
+std::vector<typename SparseMatrix<T>::value_type> operator *(const SparseMatrix<T> &lhs,
+    const std::vector<typename SparseMatrix<T>::value_type> &rhs)
+{
+    if (lhs.columns != rhs.size())
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    std::vector<typename SparseMatrix<T>::value_type> result(lhs.rows);
+    lhs.multiply(rhs.data(), 1u, 1u, result.data(), 1u);
+
+    return result;
+}
+
+// Row by row (Gustavson): row i of the product gathers the rows of rhs picked
+// by the nonzeros of row i of lhs in a dense accumulator, with a marker per
+// column recording which row last touched it. A first pass counts the
+// nonzeros of every row, so the second writes straight into the result.
+template <typename T>
+SparseMatrix<T> operator *(const SparseMatrix<T> &lhs, const SparseMatrix<T> &rhs)
+{
+    typedef typename SparseMatrix<T>::size_type size_type;
+    typedef typename SparseMatrix<T>::value_type value_type;
+
+    if (lhs.columns != rhs.rows)
+    {
+        throw std::domain_error("Matrices can't be multiplied");
+    }
+
+    SparseMatrix<T> result(lhs.rows, rhs.columns);
+    const size_type unmarked = Matrix<T>::size_max;
+    const double work = double(lhs.values.size()) * double(rhs.values.size()) / double(std::max<size_type>(rhs.rows, 1u));
+
+    lhs.for_rows(work, [&](const size_type first, const size_type last)
+    {
+        std::vector<size_type> marker(rhs.columns, unmarked);
+        for (size_type i = first; i < last; ++i)
+        {
+            size_type count = 0u;
+            for (size_type p = lhs.offsets[i]; p < lhs.offsets[i + 1u]; ++p)
+            {
+                const size_type k = lhs.indices[p];
+                for (size_type q = rhs.offsets[k]; q < rhs.offsets[k + 1u]; ++q)
+                {
+                    if (marker[rhs.indices[q]] != i)
+                    {
+                        marker[rhs.indices[q]] = i;
+                        ++count;
+                    }
+                }
+            }
+            result.offsets[i + 1u] = count;
+        }
+    });
+    std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+    result.indices.resize(result.offsets.back());
+    result.values.resize(result.offsets.back());
+
+    lhs.for_rows(work, [&](const size_type first, const size_type last)
+    {
+        std::vector<size_type> marker(rhs.columns, unmarked);
+        std::vector<value_type> accumulator(rhs.columns);
+        for (size_type i = first; i < last; ++i)
+        {
+            size_type *const row = result.indices.data() + result.offsets[i];
+            size_type count = 0u;
+            for (size_type p = lhs.offsets[i]; p < lhs.offsets[i + 1u]; ++p)
+            {
+                const value_type v = lhs.values[p];
+                const size_type k = lhs.indices[p];
+                for (size_type q = rhs.offsets[k]; q < rhs.offsets[k + 1u]; ++q)
+                {
+                    const size_type j = rhs.indices[q];
+                    if (marker[j] != i)
+                    {
+                        marker[j] = i;
+                        accumulator[j] = v * rhs.values[q];
+                        row[count++] = j;
+                    }
+                    else
+                    {
+                        accumulator[j] += v * rhs.values[q];
+                    }
+                }
+            }
+
+            std::sort(row, row + count);
+            value_type *const target = result.values.data() + result.offsets[i];
+            for (size_type c = 0u; c < count; ++c)
+            {
+                target[c] = accumulator[row[c]];
+            }
+        }
+    });
+
+    return result;
+}
+
+template <typename T>
+SparseMatrixBuilder<T>::SparseMatrixBuilder(const size_type row, const size_type column) : rows(row), columns(column),
+    row_indices(), column_indices(), values()
+{
+}
+
+template <typename T>
+void SparseMatrixBuilder<T>::reserve(const size_type count)
+{
+    row_indices.reserve(count);
+    column_indices.reserve(count);
+    values.reserve(count);
+}
+
+template <typename T>
+void SparseMatrixBuilder<T>::add(const size_type i, const size_type j, const value_type &value)
+{
+    if (i >= rows || j >= columns)
+    {
+        throw std::domain_error("Index out of range");
+    }
+
+    row_indices.push_back(i);
+    column_indices.push_back(j);
+    values.push_back(value);
+}
+
+// Leaves the builder empty.
+template <typename T>
+typename SparseMatrixBuilder<T>::sparse_type SparseMatrixBuilder<T>::build()
+{
+    const size_type count = values.size();
+    std::vector<size_type> starts(columns + 1u), order(count);
+    for (const size_type j : column_indices)
+    {
+        ++starts[j + 1u];
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    for (size_type t = 0u; t < count; ++t)
+    {
+        order[starts[column_indices[t]]++] = t;
+    }
+
+    sparse_type result(rows, columns);
+    for (const size_type i : row_indices)
+    {
+        ++result.offsets[i + 1u];
+    }
+    std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+    result.indices.resize(count);
+    result.values.resize(count);
+    std::vector<size_type> next(result.offsets.begin(), result.offsets.end() - 1);
+    for (const size_type t : order)
+    {
+        const size_type position = next[row_indices[t]]++;
+        result.indices[position] = column_indices[t];
+        result.values[position] = std::move(values[t]);
+    }
+
+    // Duplicates are adjacent now; sum them, compacting in place.
+    size_type begin = 0u, end = 0u;
+    for (size_type i = 0u; i < rows; ++i)
+    {
+        const size_type first = end, last = result.offsets[i + 1u];
+        for (size_type p = begin; p < last; ++p)
+        {
+            if (end > first && result.indices[end - 1u] == result.indices[p])
+            {
+                result.values[end - 1u] += result.values[p];
+            }
+            else
+            {
+                result.indices[end] = result.indices[p];
+                result.values[end] = result.values[p];
+                ++end;
+            }
+        }
+        begin = last;
+        result.offsets[i + 1u] = end;
+    }
+    result.indices.resize(end);
+    result.values.resize(end);
+
+    row_indices.clear();
+    column_indices.clear();
+    values.clear();
+
+    return result;
+}
+
+#endif
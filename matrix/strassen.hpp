@@ -0,0 +1,203 @@
+#ifndef __STRASSEN_HPP__
+#define __STRASSEN_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#include "./gemm.hpp"
+
+// Strassen-Winograd multiplication of square matrices: 7 half-size products
+// and 15 additions per level instead of 8 products, recursing until the order
+// drops to strassen_cutoff() and finishing with the blocked gemm. An odd order
+// is made even by peeling the last row and column, which are fixed up with
+// rank-1 and panel products afterwards. All temporaries come from one
+// workspace of about n^2 elements allocated before the recursion starts.
+//
+// The path is opt-in because it is less accurate than the conventional
+// product. With unit roundoff u, n0 = strassen_cutoff() and the max-norm
+// |M| = max |m_ij|, the computed product satisfies (Higham, Accuracy and
+// Stability of Numerical Algorithms, theorem 23.3)
+//   |C - fl(C)| <= ((n / n0)^log2(18) * (n0^2 + 6 * n0) - 6 * n) * u * |A| * |B|,
+// a normwise bound only, while the conventional product is componentwise:
+//   |c_ij - fl(c_ij)| <= n * u * sum_k |a_ik| * |b_kj|.
+// Small elements of C can therefore lose all relative accuracy, and every
+// level of recursion multiplies the error by about 4.5.
+namespace matrix_kernels
+{
+    std::atomic<std::size_t> &strassen_setting();
+    std::size_t strassen_cutoff();
+    void set_strassen_cutoff(std::size_t);
+    std::size_t strassen_workspace(std::size_t, std::size_t);
+
+    template <typename T>
+    void combine(std::size_t, const T *, std::size_t, const T *, std::size_t, T *, std::size_t, bool);
+    template <typename T>
+    void strassen(std::size_t, std::size_t, const T *, std::size_t, const T *, std::size_t, T *, std::size_t, T *);
+    template <typename T>
+    void strassen(std::size_t, const T *, std::size_t, const T *, std::size_t, T *, std::size_t);
+    template <typename T>
+    void strassen(std::size_t, std::size_t, const T *, std::size_t, const T *, std::size_t, T *, std::size_t);
+    template <typename T>
+    void multiply(std::size_t, std::size_t, std::size_t, const T *, std::size_t, const T *, std::size_t, T *, std::size_t);
+
+    inline std::atomic<std::size_t> &strassen_setting()
+    {
+        static std::atomic<std::size_t> order(0u);
+        return order;
+    }
+
+    inline std::size_t strassen_cutoff()
+    {
+        return strassen_setting().load(std::memory_order_relaxed);
+    }
+
+    // Square products larger than order use Strassen-Winograd; 0 disables it.
+    // May be called while products are running; each one reads it once.
+    inline void set_strassen_cutoff(const std::size_t order)
+    {
+        strassen_setting().store(order, std::memory_order_relaxed);
+    }
+
+    // Three half-order temporaries per level of recursion.
+    inline std::size_t strassen_workspace(std::size_t n, const std::size_t cutoff)
+    {
+        std::size_t size = 0u;
+        for (; n > cutoff; n /= 2u)
+        {
+            size += 3u * (n / 2u) * (n / 2u);
+        }
+
+        return size;
+    }
+
+    // z = x + y, or z = x - y when subtract is set; z may alias x or y.
+    template <typename T>
+    void combine(const std::size_t n, const T *const x, const std::size_t ldx, const T *const y, const std::size_t ldy,
+        T *const z, const std::size_t ldz, const bool subtract)
+    {
+        for (std::size_t i = 0u; i < n; ++i)
+        {
+            const T *const x_row = x + i * ldx;
+            const T *const y_row = y + i * ldy;
+            T *const z_row = z + i * ldz;
+            if (subtract)
+            {
+                for (std::size_t j = 0u; j < n; ++j)
+                {
+                    z_row[j] = x_row[j] - y_row[j];
+                }
+            }
+            else
+            {
+                for (std::size_t j = 0u; j < n; ++j)
+                {
+                    z_row[j] = x_row[j] + y_row[j];
+                }
+            }
+        }
+    }
+
+    // C = A * B for n x n row-major operands, workspace from strassen_workspace().
+    template <typename T>
+    void strassen(const std::size_t n, const std::size_t cutoff, const T *const a, const std::size_t lda,
+        const T *const b, const std::size_t ldb, T *const c, const std::size_t ldc, T *const workspace)
+    {
+        if (n <= cutoff)
+        {
+            for (std::size_t i = 0u; i < n; ++i)
+            {
+                std::fill(c + i * ldc, c + i * ldc + n, T());
+            }
+            gemm(n, n, n, T(1), a, lda, 1, b, ldb, 1, c, ldc);
+            return;
+        }
+
+        const std::size_t h = n / 2u, size = h * h;
+        const T *const a11 = a, *const a12 = a + h, *const a21 = a + h * lda, *const a22 = a21 + h;
+        const T *const b11 = b, *const b12 = b + h, *const b21 = b + h * ldb, *const b22 = b21 + h;
+        T *const c11 = c, *const c12 = c + h, *const c21 = c + h * ldc, *const c22 = c21 + h;
+        T *const x = workspace, *const y = x + size, *const z = y + size, *const rest = z + size;
+
+        strassen(h, cutoff, a11, lda, b11, ldb, z, h, rest);
+        strassen(h, cutoff, a12, lda, b21, ldb, c11, ldc, rest);
+        combine(h, c11, ldc, z, h, c11, ldc, false);
+
+        combine(h, a11, lda, a21, lda, x, h, true);
+        combine(h, b22, ldb, b12, ldb, y, h, true);
+        strassen(h, cutoff, x, h, y, h, c21, ldc, rest);
+
+        combine(h, a21, lda, a22, lda, x, h, false);
+        combine(h, b12, ldb, b11, ldb, y, h, true);
+        strassen(h, cutoff, x, h, y, h, c22, ldc, rest);
+
+        combine(h, x, h, a11, lda, x, h, true);
+        combine(h, b22, ldb, y, h, y, h, true);
+        strassen(h, cutoff, x, h, y, h, c12, ldc, rest);
+
+        combine(h, c12, ldc, z, h, c12, ldc, false);
+        combine(h, c21, ldc, c12, ldc, c21, ldc, false);
+        combine(h, c12, ldc, c22, ldc, c12, ldc, false);
+        combine(h, c22, ldc, c21, ldc, c22, ldc, false);
+
+        combine(h, a12, lda, x, h, x, h, true);
+        strassen(h, cutoff, x, h, b22, ldb, z, h, rest);
+        combine(h, c12, ldc, z, h, c12, ldc, false);
+
+        combine(h, y, h, b21, ldb, y, h, true);
+        strassen(h, cutoff, a22, lda, y, h, z, h, rest);
+        combine(h, c21, ldc, z, h, c21, ldc, true);
+
+        if (n % 2u)
+        {
+            const std::size_t e = n - 1u;
+            // Leading block: add the outer product of A's last column and
+            // B's last row. Then the last column and the last row of C.
+            gemm(e, e, 1u, T(1), a + e, lda, 1, b + e * ldb, ldb, 1, c, ldc);
+            for (std::size_t i = 0u; i < n; ++i)
+            {
+                c[i * ldc + e] = T();
+            }
+            std::fill(c + e * ldc, c + e * ldc + e, T());
+            gemm(n, 1u, n, T(1), a, lda, 1, b + e, ldb, 1, c + e, ldc);
+            gemm(1u, e, n, T(1), a + e * lda, lda, 1, b, ldb, 1, c + e * ldc, ldc);
+        }
+    }
+
+    template <typename T>
+    void strassen(const std::size_t n, const T *const a, const std::size_t lda,
+        const T *const b, const std::size_t ldb, T *const c, const std::size_t ldc)
+    {
+        strassen(n, std::max<std::size_t>(strassen_cutoff(), 1u), a, lda, b, ldb, c, ldc);
+    }
+
+    template <typename T>
+    void strassen(const std::size_t n, const std::size_t cutoff, const T *const a, const std::size_t lda,
+        const T *const b, const std::size_t ldb, T *const c, const std::size_t ldc)
+    {
+        Buffer<T> workspace(strassen_workspace(n, cutoff));
+        strassen(n, cutoff, a, lda, b, ldb, c, ldc, workspace.data());
+    }
+
+    // C = A * B for row-major operands, through Strassen-Winograd when the
+    // product is square and larger than strassen_cutoff(), gemm otherwise.
+    template <typename T>
+    void multiply(const std::size_t m, const std::size_t n, const std::size_t l,
+        const T *const a, const std::size_t lda, const T *const b, const std::size_t ldb, T *const c, const std::size_t ldc)
+    {
+        const std::size_t cutoff = strassen_cutoff();
+        if (cutoff && m == n && n == l && n > cutoff)
+        {
+            strassen(n, cutoff, a, lda, b, ldb, c, ldc);
+            return;
+        }
+
+        for (std::size_t i = 0u; i < m; ++i)
+        {
+            std::fill(c + i * ldc, c + i * ldc + n, T());
+        }
+        gemm(m, n, l, T(1), a, lda, 1, b, ldb, 1, c, ldc);
+    }
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef __TASK_GRAPH_HPP__
+#define __TASK_GRAPH_HPP__
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "./thread_pool.hpp"
+
+// Dataflow scheduler. Tasks are added in program order together with the keys
+// of the data they read and write; a task waits for the last writer of every
+// key it reads, and for the last writer and the readers since of every key it
+// writes. run() then executes the graph with every pool thread taking the
+// highest priority ready task, earliest added first, so independent steps of
+// different iterations overlap. Tasks must not start parallel work of their
+// own on the same pool.
+class TaskGraph
+{
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Node
+    {
+        Task task;
+        int priority;
+        std::size_t waiting;
+        std::vector<std::size_t> successors;
+    };
+
+    struct Access
+    {
+        bool written;
+        std::size_t writer;
+        std::vector<std::size_t> readers;
+    };
+
+    std::vector<Node> nodes;
+    std::unordered_map<std::size_t, Access> accesses;
+
+    void depend(std::size_t, std::size_t);
+
+public:
+    std::size_t add(Task, const std::vector<std::size_t> &, const std::vector<std::size_t> &, int = 0);
+    std::size_t size() const noexcept;
+    void run(ThreadPool *);
+};
+
+inline void TaskGraph::depend(const std::size_t before, const std::size_t after)
+{
+    nodes[before].successors.push_back(after);
+    ++nodes[after].waiting;
+}
+
+inline std::size_t TaskGraph::add(Task task, const std::vector<std::size_t> &reads, const std::vector<std::size_t> &writes,
+    const int priority)
+{
+    const std::size_t id = nodes.size();
+    nodes.push_back(Node{std::move(task), priority, 0u, {}});
+    for (const std::size_t key : reads)
+    {
+        Access &access = accesses[key];
+        if (access.written)
+        {
+            depend(access.writer, id);
+        }
+        access.readers.push_back(id);
+    }
+    for (const std::size_t key : writes)
+    {
+        Access &access = accesses[key];
+        if (access.written)
+        {
+            depend(access.writer, id);
+        }
+        for (const std::size_t reader : access.readers)
+        {
+            if (reader != id)
+            {
+                depend(reader, id);
+            }
+        }
+        access.written = true;
+        access.writer = id;
+        access.readers.clear();
+    }
+
+    return id;
+}
+
+inline std::size_t TaskGraph::size() const noexcept
+{
+    return nodes.size();
+}
+
+// Runs every task on the calling thread and the workers, if any, and clears
+// the graph. After a task throws the remaining ones are skipped and the first
+// exception is rethrown here.
+inline void TaskGraph::run(ThreadPool *const workers)
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::priority_queue<std::pair<int, std::size_t>> ready;
+    std::size_t remaining = nodes.size();
+    std::exception_ptr error;
+
+    const std::size_t count = nodes.size();
+    for (std::size_t id = 0u; id < count; ++id)
+    {
+        if (!nodes[id].waiting)
+        {
+            ready.emplace(nodes[id].priority, count - id);
+        }
+    }
+
+    const auto loop = [&]()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            changed.wait(lock, [&]() { return !remaining || !ready.empty(); });
+            if (!remaining)
+            {
+                return;
+            }
+
+            const std::size_t id = count - ready.top().second;
+            ready.pop();
+            const bool skip = bool(error);
+            lock.unlock();
+
+            std::exception_ptr failure;
+            if (!skip)
+            {
+                try
+                {
+                    nodes[id].task();
+                }
+                catch (...)
+                {
+                    failure = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if (failure && !error)
+            {
+                error = failure;
+            }
+            --remaining;
+            for (const std::size_t successor : nodes[id].successors)
+            {
+                if (!--nodes[successor].waiting)
+                {
+                    ready.emplace(nodes[successor].priority, count - successor);
+                }
+            }
+            changed.notify_all();
+        }
+    };
+
+    if (workers && count > 1u)
+    {
+        workers->run(workers->size() + 1u, [&](std::size_t) { loop(); });
+    }
+    else
+    {
+        loop();
+    }
+
+    nodes.clear();
+    accesses.clear();
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef __THREAD_POOL_HPP__
+#define __THREAD_POOL_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool: every worker owns a deque, takes its own tasks from the
+// back and steals from the front of the others. A thread that waits for a
+// batch runs queued tasks meanwhile, so batches may be started from inside
+// tasks without deadlocking.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct Batch
+    {
+        std::atomic<std::size_t> remaining;
+        std::mutex mutex;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::atomic<std::size_t> queued;
+    std::atomic<std::size_t> next_queue;
+    bool stopping;
+
+    static ThreadPool *&current_pool();
+    static std::size_t &current_queue();
+
+    std::size_t home() noexcept;
+    bool run_one(std::size_t);
+    void work(std::size_t);
+
+public:
+    explicit ThreadPool(std::size_t);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator =(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    std::size_t size() const noexcept;
+
+    template <typename Function>
+    void run(std::size_t, const Function &);
+};
+
+inline ThreadPool *&ThreadPool::current_pool()
+{
+    thread_local ThreadPool *pool = nullptr;
+    return pool;
+}
+
+inline std::size_t &ThreadPool::current_queue()
+{
+    thread_local std::size_t queue = 0u;
+    return queue;
+}
+
+// Workers use their own deque; other threads spread their batches round-robin.
+inline std::size_t ThreadPool::home() noexcept
+{
+    return current_pool() == this ? current_queue() : next_queue.fetch_add(1u, std::memory_order_relaxed) % queues.size();
+}
+
+inline bool ThreadPool::run_one(const std::size_t own)
+{
+    const std::size_t count = queues.size();
+    for (std::size_t k = 0u; k < count; ++k)
+    {
+        Queue &queue = *queues[(own + k) % count];
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+
+        Task task;
+        if (k == 0u)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued.fetch_sub(1u, std::memory_order_relaxed);
+        lock.unlock();
+
+        task();
+        return true;
+    }
+
+    return false;
+}
+
+inline void ThreadPool::work(const std::size_t own)
+{
+    current_pool() = this;
+    current_queue() = own;
+    while (true)
+    {
+        if (run_one(own))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return stopping || queued.load(std::memory_order_relaxed); });
+        if (stopping && !queued.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+// threads is the number of workers; the thread calling run() helps as well.
+inline ThreadPool::ThreadPool(const std::size_t threads) : queues(), workers(), mutex(), changed(),
+    queued(0u), next_queue(0u), stopping(false)
+{
+    for (std::size_t i = 0u; i < std::max<std::size_t>(threads, 1u); ++i)
+    {
+        queues.emplace_back(new Queue);
+    }
+    for (std::size_t i = 0u; i < threads; ++i)
+    {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+inline std::size_t ThreadPool::size() const noexcept
+{
+    return workers.size();
+}
+
+// Calls function(i) for every i < count and returns once all calls are done.
+// The first exception thrown by a call is rethrown here.
+template <typename Function>
+void ThreadPool::run(const std::size_t count, const Function &function)
+{
+    if (!count)
+    {
+        return;
+    }
+
+    Batch batch;
+    batch.remaining.store(count, std::memory_order_relaxed);
+    const std::size_t own = home();
+    {
+        // Counting under the pool mutex keeps sleeping workers from missing
+        // the wake-up; the queue is always locked after it, never before.
+        std::lock_guard<std::mutex> lock(mutex);
+        Queue &queue = *queues[own];
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+        for (std::size_t i = count; i-- > 0u;)
+        {
+            queue.tasks.emplace_back([this, &batch, &function, i]()
+            {
+                try
+                {
+                    function(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> error_lock(batch.mutex);
+                    if (!batch.error)
+                    {
+                        batch.error = std::current_exception();
+                    }
+                }
+                if (batch.remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    changed.notify_all();
+                }
+            });
+        }
+        queued.fetch_add(count, std::memory_order_relaxed);
+    }
+    changed.notify_all();
+
+    while (batch.remaining.load(std::memory_order_acquire))
+    {
+        if (!run_one(own))
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this, &batch]()
+            {
+                return !batch.remaining.load(std::memory_order_acquire) || queued.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    if (batch.error)
+    {
+        std::rethrow_exception(batch.error);
+    }
+}
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef __TRANSPOSE_HPP__
+#define __TRANSPOSE_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "./gemm.hpp"
+
+// Cache-oblivious transpose: the longer side is halved until a block fits in
+// L1 together with its image, whatever the cache sizes are, and the block is
+// transposed in tile x tile pieces held in registers. Float and double use
+// AVX tiles, 8 x 8 and 4 x 4, picked at run time like the gemm kernels.
+namespace matrix_kernels
+{
+    template <typename T>
+    struct TransposeKernel
+    {
+        // B[n x m] (row stride ldb) = A[m x n]^T (row stride lda).
+        typedef void (*function_type)(std::size_t, std::size_t, const T *, std::size_t, T *, std::size_t);
+
+        function_type function;
+        std::size_t tile;
+        std::size_t block;
+    };
+
+    template <typename T>
+    TransposeKernel<T> make_transpose_kernel(typename TransposeKernel<T>::function_type, std::size_t);
+    template <typename T>
+    void generic_transpose(std::size_t, std::size_t, const T *, std::size_t, T *, std::size_t);
+    template <typename T>
+    TransposeKernel<T> select_transpose_kernel();
+    template <typename T>
+    const TransposeKernel<T> &transpose_kernel();
+
+    template <typename T>
+    void transpose(const TransposeKernel<T> &, std::size_t, std::size_t, const T *, std::size_t, T *, std::size_t);
+    template <typename T>
+    void transpose(std::size_t, std::size_t, const T *, std::size_t, T *, std::size_t);
+    template <typename T>
+    void transpose_square(std::size_t, T *, std::size_t);
+    template <typename T>
+    void transpose_in_place(std::size_t, std::size_t, T *);
+
+    template <typename T>
+    TransposeKernel<T> make_transpose_kernel(const typename TransposeKernel<T>::function_type function, const std::size_t tile)
+    {
+        // A block and its image fill half of L1.
+        const std::size_t side = std::size_t(std::sqrt(double(L1_BYTES / 4u / sizeof(T))));
+        return TransposeKernel<T>{function, tile, std::max(side / tile * tile, tile)};
+    }
+
+    template <typename T>
+    void generic_transpose(const std::size_t m, const std::size_t n, const T *const a, const std::size_t lda,
+        T *const b, const std::size_t ldb)
+    {
+        for (std::size_t i = 0u; i < m; ++i)
+        {
+            for (std::size_t j = 0u; j < n; ++j)
+            {
+                b[j * ldb + i] = a[i * lda + j];
+            }
+        }
+    }
+
+#ifdef MATRIX_X86_KERNELS
+    namespace sandybridge
+    {
+        __attribute__((target("avx")))
+        inline void transpose_tile(const double *const a, const std::size_t lda, double *const b, const std::size_t ldb)
+        {
+            const __m256d r0 = _mm256_loadu_pd(a), r1 = _mm256_loadu_pd(a + lda);
+            const __m256d r2 = _mm256_loadu_pd(a + 2u * lda), r3 = _mm256_loadu_pd(a + 3u * lda);
+            const __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+            const __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+            _mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(b + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(b + 2u * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(b + 3u * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+
+        __attribute__((target("avx")))
+        inline void transpose_tile(const float *const a, const std::size_t lda, float *const b, const std::size_t ldb)
+        {
+            __m256 r[8], t[8];
+            for (std::size_t i = 0u; i < 8u; ++i)
+            {
+                r[i] = _mm256_loadu_ps(a + i * lda);
+            }
+            for (std::size_t i = 0u; i < 8u; i += 2u)
+            {
+                t[i] = _mm256_unpacklo_ps(r[i], r[i + 1u]);
+                t[i + 1u] = _mm256_unpackhi_ps(r[i], r[i + 1u]);
+            }
+            for (std::size_t i = 0u; i < 8u; i += 4u)
+            {
+                r[i] = _mm256_shuffle_ps(t[i], t[i + 2u], _MM_SHUFFLE(1, 0, 1, 0));
+                r[i + 1u] = _mm256_shuffle_ps(t[i], t[i + 2u], _MM_SHUFFLE(3, 2, 3, 2));
+                r[i + 2u] = _mm256_shuffle_ps(t[i + 1u], t[i + 3u], _MM_SHUFFLE(1, 0, 1, 0));
+                r[i + 3u] = _mm256_shuffle_ps(t[i + 1u], t[i + 3u], _MM_SHUFFLE(3, 2, 3, 2));
+            }
+            for (std::size_t i = 0u; i < 4u; ++i)
+            {
+                _mm256_storeu_ps(b + i * ldb, _mm256_permute2f128_ps(r[i], r[i + 4u], 0x20));
+                _mm256_storeu_ps(b + (i + 4u) * ldb, _mm256_permute2f128_ps(r[i], r[i + 4u], 0x31));
+            }
+        }
+
+        // Whole tiles go through registers, the ragged right and bottom
+        // edges element by element.
+        template <typename T, std::size_t Tile>
+        __attribute__((target("avx")))
+        void transpose(const std::size_t m, const std::size_t n, const T *const a, const std::size_t lda,
+            T *const b, const std::size_t ldb)
+        {
+            const std::size_t mt = m / Tile * Tile, nt = n / Tile * Tile;
+            for (std::size_t i = 0u; i < mt; i += Tile)
+            {
+                for (std::size_t j = 0u; j < nt; j += Tile)
+                {
+                    transpose_tile(a + i * lda + j, lda, b + j * ldb + i, ldb);
+                }
+            }
+            for (std::size_t i = 0u; i < m; ++i)
+            {
+                for (std::size_t j = i < mt ? nt : 0u; j < n; ++j)
+                {
+                    b[j * ldb + i] = a[i * lda + j];
+                }
+            }
+        }
+    }
+#endif
+
+    template <typename T>
+    TransposeKernel<T> select_transpose_kernel()
+    {
+        return make_transpose_kernel<T>(&generic_transpose<T>, 1u);
+    }
+
+#ifdef MATRIX_X86_KERNELS
+    template <>
+    inline TransposeKernel<double> select_transpose_kernel<double>()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx"))
+        {
+            return make_transpose_kernel<double>(&sandybridge::transpose<double, 4u>, 4u);
+        }
+        return make_transpose_kernel<double>(&generic_transpose<double>, 1u);
+    }
+
+    template <>
+    inline TransposeKernel<float> select_transpose_kernel<float>()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx"))
+        {
+            return make_transpose_kernel<float>(&sandybridge::transpose<float, 8u>, 8u);
+        }
+        return make_transpose_kernel<float>(&generic_transpose<float>, 1u);
+    }
+#endif
+
+    template <typename T>
+    const TransposeKernel<T> &transpose_kernel()
+    {
+        static const TransposeKernel<T> instance(select_transpose_kernel<T>());
+        return instance;
+    }
+
+    // Splits keep whole tiles on the leading side.
+    template <typename T>
+    void transpose(const TransposeKernel<T> &k, const std::size_t m, const std::size_t n, const T *const a, const std::size_t lda,
+        T *const b, const std::size_t ldb)
+    {
+        if (m <= k.block && n <= k.block)
+        {
+            k.function(m, n, a, lda, b, ldb);
+        }
+        else if (m >= n)
+        {
+            const std::size_t h = std::max(m / 2u / k.tile * k.tile, k.tile);
+            transpose(k, h, n, a, lda, b, ldb);
+            transpose(k, m - h, n, a + h * lda, lda, b + h, ldb);
+        }
+        else
+        {
+            const std::size_t h = std::max(n / 2u / k.tile * k.tile, k.tile);
+            transpose(k, m, h, a, lda, b, ldb);
+            transpose(k, m, n - h, a + h, lda, b + h * ldb, ldb);
+        }
+    }
+
+    // B[n x m] = A[m x n]^T for row-major operands that do not overlap.
+    template <typename T>
+    void transpose(const std::size_t m, const std::size_t n, const T *const a, const std::size_t lda,
+        T *const b, const std::size_t ldb)
+    {
+        if (m && n)
+        {
+            transpose(transpose_kernel<T>(), m, n, a, lda, b, ldb);
+        }
+    }
+
+    // A[n x n] = A^T, swapping mirrored blocks of transpose_kernel().block.
+    template <typename T>
+    void transpose_square(const std::size_t n, T *const a, const std::size_t lda)
+    {
+        const std::size_t block = transpose_kernel<T>().block;
+        for (std::size_t ib = 0u; ib < n; ib += block)
+        {
+            const std::size_t ie = std::min(n, ib + block);
+            for (std::size_t i = ib + 1u; i < ie; ++i)
+            {
+                for (std::size_t j = ib; j < i; ++j)
+                {
+                    std::swap(a[i * lda + j], a[j * lda + i]);
+                }
+            }
+            for (std::size_t jb = ie; jb < n; jb += block)
+            {
+                const std::size_t je = std::min(n, jb + block);
+                for (std::size_t i = ib; i < ie; ++i)
+                {
+                    for (std::size_t j = jb; j < je; ++j)
+                    {
+                        std::swap(a[i * lda + j], a[j * lda + i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // The m x n row-major array a becomes its n x m transpose in place.
+    // Element i * n + j moves to j * m + i; every permutation cycle is
+    // followed once, carrying one element, with one bit per element marking
+    // the positions already filled.
+    template <typename T>
+    void transpose_in_place(const std::size_t m, const std::size_t n, T *const a)
+    {
+        if (m < 2u || n < 2u)
+        {
+            return;
+        }
+
+        const std::size_t size = m * n;
+        std::vector<bool> moved(size);
+        for (std::size_t start = 1u; start < size - 1u; ++start)
+        {
+            if (moved[start])
+            {
+                continue;
+            }
+
+            T value = std::move(a[start]);
+            std::size_t k = start;
+            do
+            {
+                k = k % n * m + k / n;
+                std::swap(value, a[k]);
+                moved[k] = true;
+            }
+            while (k != start);
+        }
+    }
+}
+
+#endif